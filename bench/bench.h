@@ -0,0 +1,37 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+
+#include <Python.h>
+
+#include "libpy/object.h"
+
+namespace bench {
+constexpr std::size_t iterations = 1000000;
+
+/**
+   The number of nanoseconds per iteration of `f`.
+*/
+template<typename F>
+double time_ns(F &&f) {
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t n = 0; n < iterations; ++n) {
+        py::tmpref<py::object> result = f();
+        if (!result.is_nonnull()) {
+            PyErr_Print();
+            return -1;
+        }
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+/**
+   Evaluate a Python expression with the builtins in scope.
+*/
+inline py::tmpref<py::object> eval(const char *expr) {
+    PyObject *ns = PyEval_GetBuiltins();
+    return PyRun_String(expr, Py_eval_input, ns, ns);
+}
+}
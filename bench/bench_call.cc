@@ -0,0 +1,104 @@
+#include <cstdio>
+#include <utility>
+
+#include <Python.h>
+
+#include "libpy/libpy.h"
+#include "bench.h"
+
+using py::operator""_p;
+using py::operator""_kw;
+
+namespace {
+using bench::eval;
+using bench::time_ns;
+
+/**
+   Compare `f(args...)` against the tuple packing path that
+   `py::object::operator()` used before vectorcall and against
+   `py::prepared_call`.
+*/
+template<typename... Ts>
+void bench_call(const char *name, const py::object &f, const Ts&... args) {
+    py::prepared_call<sizeof...(Ts)> prepared(f);
+
+    double vectorcall = time_ns([&] { return f(args...); });
+    double tuple = time_ns([&] { return f.call(py::tuple::pack(args...)); });
+    double invoke = time_ns([&] { return prepared.invoke(args...); });
+
+    std::printf("%-10s %zu args: vectorcall %8.2f ns  tuple %8.2f ns  "
+                "prepared_call %8.2f ns\n",
+                name,
+                sizeof...(Ts),
+                vectorcall,
+                tuple,
+                invoke);
+}
+
+template<typename... Ts>
+void bench_arity(const char *fexpr, const char *mexpr, const Ts&... args) {
+    auto f = eval(fexpr);
+    auto m = eval(mexpr);
+    if (!pyutils::all_nonnull(f, m)) {
+        PyErr_Print();
+        return;
+    }
+    bench_call("function", f, args...);
+    bench_call("method", m, args...);
+}
+/**
+   Compare `f(a, "b"_kw = b)` against packing a `tuple` and a `dict`.
+*/
+void bench_kwargs(const py::object &a) {
+    auto f = eval("lambda a, *, b: None");
+    if (!f.is_nonnull()) {
+        PyErr_Print();
+        return;
+    }
+
+    double vectorcall = time_ns([&] { return f(a, "b"_kw = a); });
+    double dict = time_ns([&] {
+        py::tmpref<py::object> kwargs = PyDict_New();
+        if (!kwargs.is_nonnull() || kwargs.setitem("b"_p, a)) {
+            return py::tmpref<py::object>(nullptr);
+        }
+        return f.call(py::tuple::pack(a), kwargs);
+    });
+
+    std::printf("%-10s kwargs: vectorcall %8.2f ns  dict  %8.2f ns\n",
+                "function",
+                vectorcall,
+                dict);
+}
+}
+
+int main() {
+    Py_Initialize();
+
+    // define the class in builtins so that the method expressions can use it
+    PyRun_SimpleString("import builtins\n"
+                       "class C:\n"
+                       "    def f0(self): pass\n"
+                       "    def f1(self, a): pass\n"
+                       "    def f2(self, a, b): pass\n"
+                       "    def f3(self, a, b, c): pass\n"
+                       "    def f4(self, a, b, c, d): pass\n"
+                       "    def f5(self, a, b, c, d, e): pass\n"
+                       "    def f6(self, a, b, c, d, e, f): pass\n"
+                       "builtins._bench_c = C()\n");
+
+    auto a = 1_p;
+    bench_arity("lambda: None", "_bench_c.f0");
+    bench_arity("lambda a: None", "_bench_c.f1", a);
+    bench_arity("lambda a, b: None", "_bench_c.f2", a, a);
+    bench_arity("lambda a, b, c: None", "_bench_c.f3", a, a, a);
+    bench_arity("lambda a, b, c, d: None", "_bench_c.f4", a, a, a, a);
+    bench_arity("lambda a, b, c, d, e: None", "_bench_c.f5", a, a, a, a, a);
+    bench_arity("lambda a, b, c, d, e, f: None",
+                "_bench_c.f6",
+                a, a, a, a, a, a);
+    bench_kwargs(a);
+
+    Py_Finalize();
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include <cstdio>
+
+#include <Python.h>
+
+#include "libpy/libpy.h"
+#include "bench.h"
+
+using py::operator""_p;
+
+namespace {
+using bench::eval;
+using bench::time_ns;
+
+/**
+   Compare `ob.getattr(cache)` with `ob.getattr(name)`.
+*/
+void bench_getattr(const char *label, const char *expr) {
+    auto ob = eval(expr);
+    if (!ob.is_nonnull()) {
+        PyErr_Print();
+        return;
+    }
+
+    py::attrcache cache("x"_p);
+    double cached = time_ns([&] { return ob.getattr(cache); });
+    double uncached = time_ns([&] { return ob.getattr("x"_p); });
+
+    std::printf("%-10s attrcache %8.2f ns  getattr %8.2f ns\n",
+                label,
+                cached,
+                uncached);
+}
+}
+
+int main() {
+    Py_Initialize();
+
+    PyRun_SimpleString("import builtins\n"
+                       "class Slots:\n"
+                       "    __slots__ = ('x',)\n"
+                       "    def __init__(self):\n"
+                       "        self.x = 1\n"
+                       "class Prop:\n"
+                       "    @property\n"
+                       "    def x(self):\n"
+                       "        return 1\n"
+                       "class Method:\n"
+                       "    def x(self):\n"
+                       "        pass\n"
+                       "class Instance:\n"
+                       "    def __init__(self):\n"
+                       "        self.x = 1\n"
+                       "builtins._bench_classes = "
+                       "(Slots, Prop, Method, Instance)\n");
+
+    bench_getattr("slot", "_bench_classes[0]()");
+    bench_getattr("property", "_bench_classes[1]()");
+    bench_getattr("method", "_bench_classes[2]()");
+    bench_getattr("instance", "_bench_classes[3]()");
+
+    Py_Finalize();
+    return 0;
+}
@@ -0,0 +1,148 @@
+#pragma once
+#include <Python.h>
+#include <structmember.h>
+
+#include "libpy/object.h"
+
+namespace py {
+/**
+   A cache for looking up a single attribute on objects of the same type.
+
+   The cache records the type's version tag along with how the attribute
+   was resolved: a member slot offset, a descriptor, or the instance
+   `__dict__`. Later lookups on objects of the same type skip the MRO
+   walk until the type, or one of its bases, is modified.
+
+   Objects whose type overrides `__getattribute__` or `__getattr__` are
+   not cached and always go through `PyObject_GetAttr`.
+
+   On 3.11+ instances of ordinary classes store their attributes inline
+   until something asks for their `__dict__`. Lookups which need to
+   check the instance `__dict__` create it, so those objects no longer
+   use the inline values.
+
+   Caches are meant to have static storage duration, one per call site,
+   for example: `static py::attrcache cache("x"_p);` followed by
+   `ob.getattr(cache)`. The cache holds a reference to `name` which is
+   never released, like the objects returned by the `_p` literals.
+*/
+class attrcache {
+private:
+    enum class kind {
+        /**
+           Nothing is cached.
+        */
+        none,
+
+        /**
+           The attribute is a `PyMemberDef` on the type, for example a
+           `__slots__` entry.
+        */
+        member,
+
+        /**
+           The attribute is a data descriptor on the type, for example a
+           `property`.
+        */
+        data_descr,
+
+        /**
+           The attribute is a non-data descriptor or plain value on the
+           type, for example a method. The instance `__dict__` is checked
+           first.
+        */
+        type_attr,
+
+        /**
+           The type does not have the attribute, it may only be found in
+           the instance `__dict__`.
+        */
+        instance_attr,
+    };
+
+    PyObject *name;
+    PyTypeObject *type;
+    unsigned int version_tag;
+    kind cached;
+
+    // These are borrowed from the type's dict. They are only valid while
+    // the type's version tag is unchanged.
+    PyObject *descr;
+    descrgetfunc descr_get;
+    PyMemberDef *member;
+
+    /**
+       Check if the cache entry is still valid for objects of type `tp`.
+    */
+    inline bool valid(PyTypeObject *tp) const {
+        return tp == type &&
+            PyType_HasFeature(tp, Py_TPFLAGS_VALID_VERSION_TAG) &&
+            tp->tp_version_tag == version_tag;
+    }
+
+    /**
+       Look for the attribute in the instance `__dict__`.
+
+       @return A new reference to the attribute, or nullptr without an
+               exception set if it is not in the `__dict__`, or nullptr
+               with an exception set if the `__dict__` could not be
+               read.
+    */
+    PyObject *from_dict(PyObject *ob) const;
+
+    /**
+       Rebuild the cache for `Py_TYPE(ob)` and then look up the attribute.
+    */
+    PyObject *refresh(PyObject *ob);
+
+    /**
+       Look up the attribute using the cached resolution.
+    */
+    PyObject *lookup(PyObject *ob) const;
+
+public:
+    /**
+       Create a cache for the attribute `name`.
+
+       @param name The name of the attribute as a string object.
+    */
+    explicit attrcache(const object &name);
+
+    attrcache(const attrcache&) = delete;
+    attrcache &operator=(const attrcache&) = delete;
+
+    /**
+       Get the attribute from `ob`.
+
+       This is equivalent to: `ob.getattr(name)`.
+
+       @param ob The object to get the attribute from.
+       @return   The attribute.
+    */
+    inline tmpref<object> get(const object &ob) {
+        PyObject *pob = ob;
+        if (!pob) {
+            pyutils::failed_null_check();
+            return nullptr;
+        }
+
+        if (!valid(Py_TYPE(pob))) {
+            return refresh(pob);
+        }
+
+        if (cached == kind::member && member->type == T_OBJECT_EX) {
+            PyObject *value = *reinterpret_cast<PyObject**>(
+                reinterpret_cast<char*>(pob) + member->offset);
+            if (value) {
+                Py_INCREF(value);
+                return value;
+            }
+        }
+        return lookup(pob);
+    }
+};
+
+inline tmpref<object> object::getattr(attrcache &cache) const {
+    return cache.get(*this);
+}
+}
@@ -1,18 +1,40 @@
 #pragma once
 #include <array>
+#include <climits>
 #include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+#include <string>
 #include <tuple>
+#include <type_traits>
+#include <utility>
 
 #include <Python.h>
 
+#include "libpy/automethod_stats.h"
 #include "libpy/object.h"
+#include "libpy/to_python.h"
 #include "libpy/utils.h"
 
+#define HAVE_FASTCALL (PY_VERSION_HEX >= 0x03070000)
+
 namespace pyutils {
 /**
    The format character for the given type. The default case is left
    unitialized to generate a compile-time error if you attempt to use
    auto method on a type that has no format character.
+
+   Specializations may also provide a typed converter:
+   `static bool convert(PyObject *ob, T &out)` which returns false with a
+   Python exception set on failure. When a converter is not provided the
+   argument is parsed with `PyArg_Parse` and the format character.
+
+   Types which may be used with `automethod_overloads` provide
+   `static PyTypeObject *exact_type()` which returns the type an argument
+   must have to select an overload, or nullptr to accept any object.
+   Types which accept more than one exact type instead provide
+   `static bool exact_match(PyObject *ob)`.
 */
 template<typename T>
 struct typeformat {};
@@ -24,96 +46,351 @@ struct _default_make_arg {
     }
 };
 
+/**
+   Raise a `TypeError` for an argument of the wrong type.
+
+   @param expected The name of the expected type.
+   @param ob       The argument that was received.
+   @return         false.
+*/
+inline bool _bad_argument_type(const char *expected, PyObject *ob) {
+    PyErr_Format(PyExc_TypeError,
+                 "must be %.50s, not %.50s",
+                 expected,
+                 Py_TYPE(ob)->tp_name);
+    return false;
+}
+
+/**
+   Converter for integral types which are range checked.
+*/
+template<typename T>
+struct _checked_integral_convert {
+    static inline PyTypeObject *exact_type() {
+        return &PyLong_Type;
+    }
+
+    static inline bool convert(PyObject *ob, T &out) {
+        if (PyFloat_Check(ob)) {
+            PyErr_SetString(PyExc_TypeError,
+                            "integer argument expected, got float");
+            return false;
+        }
+
+        long long value = PyLong_AsLongLong(ob);
+        if (value == -1 && PyErr_Occurred()) {
+            return false;
+        }
+        if (value < std::numeric_limits<T>::min()) {
+            PyErr_SetString(PyExc_OverflowError,
+                            "integer is less than minimum");
+            return false;
+        }
+        if (value > std::numeric_limits<T>::max()) {
+            PyErr_SetString(PyExc_OverflowError,
+                            "integer is greater than maximum");
+            return false;
+        }
+        out = static_cast<T>(value);
+        return true;
+    }
+};
+
+/**
+   Converter for unsigned integral types which are not range checked.
+
+   @tparam require_long Only accept `int` objects, not objects which
+                        implement `__index__`.
+*/
+template<typename T, bool require_long>
+struct _masked_integral_convert {
+    static inline PyTypeObject *exact_type() {
+        return &PyLong_Type;
+    }
+
+    static inline bool convert(PyObject *ob, T &out) {
+        if (require_long && !PyLong_Check(ob)) {
+            return _bad_argument_type("int", ob);
+        }
+        if (PyFloat_Check(ob)) {
+            PyErr_SetString(PyExc_TypeError,
+                            "integer argument expected, got float");
+            return false;
+        }
+
+        unsigned long long value = PyLong_AsUnsignedLongLongMask(ob);
+        if (value == static_cast<unsigned long long>(-1) &&
+            PyErr_Occurred()) {
+            return false;
+        }
+        out = static_cast<T>(value);
+        return true;
+    }
+};
+
+/**
+   Converter for floating point types.
+*/
+template<typename T>
+struct _floating_convert {
+    static inline PyTypeObject *exact_type() {
+        return &PyFloat_Type;
+    }
+
+    static inline bool convert(PyObject *ob, T &out) {
+        double value = PyFloat_AsDouble(ob);
+        if (value == -1.0 && PyErr_Occurred()) {
+            return false;
+        }
+        out = static_cast<T>(value);
+        return true;
+    }
+};
+
+/**
+   Converter for types which are just the borrowed object.
+*/
+template<typename T>
+struct _object_convert {
+    static inline PyTypeObject *exact_type() {
+        return nullptr;
+    }
+
+    static inline bool convert(PyObject *ob, T &out) {
+        out = ob;
+        return true;
+    }
+};
+
 template<>
 struct typeformat<const char*> : public _default_make_arg {
     static char_sequence<'z'> cs;
-};
 
-template<>
-struct typeformat<Py_buffer> : public _default_make_arg {
-    static char_sequence<'s'> cs;
+    static inline PyTypeObject *exact_type() {
+        return &PyUnicode_Type;
+    }
+
+    static inline bool convert(PyObject *ob, const char *&out) {
+        if (ob == Py_None) {
+            out = nullptr;
+            return true;
+        }
+        if (!PyUnicode_Check(ob)) {
+            return _bad_argument_type("str or None", ob);
+        }
+        Py_ssize_t size;
+        if (!(out = PyUnicode_AsUTF8AndSize(ob, &size))) {
+            return false;
+        }
+        // like the 'z' format, reject strings which C would truncate
+        if (std::strlen(out) != static_cast<std::size_t>(size)) {
+            PyErr_SetString(PyExc_ValueError, "embedded null character");
+            return false;
+        }
+        return true;
+    }
 };
 
+/* There is no `typeformat<Py_buffer>`: a buffer must be released after
+   the call, use `py::buffer_view<T>` for buffer parameters instead. */
+
 template<>
 struct typeformat<char> : public _default_make_arg {
     static char_sequence<'c'> cs;
+
+    static inline PyTypeObject *exact_type() {
+        return &PyBytes_Type;
+    }
+
+    static inline bool convert(PyObject *ob, char &out) {
+        if (PyBytes_Check(ob) && PyBytes_GET_SIZE(ob) == 1) {
+            out = PyBytes_AS_STRING(ob)[0];
+            return true;
+        }
+        if (PyByteArray_Check(ob) && PyByteArray_GET_SIZE(ob) == 1) {
+            out = PyByteArray_AS_STRING(ob)[0];
+            return true;
+        }
+        return _bad_argument_type("a byte string of length 1", ob);
+    }
 };
 
 template<>
-struct typeformat<unsigned char> : public _default_make_arg {
+struct typeformat<unsigned char>
+    : public _default_make_arg,
+      public _checked_integral_convert<unsigned char> {
     static char_sequence<'b'> cs;
 };
 
 template<>
-struct typeformat<short> : public _default_make_arg {
+struct typeformat<short>
+    : public _default_make_arg,
+      public _checked_integral_convert<short> {
     static char_sequence<'h'> cs;
 };
 
 template<>
-struct typeformat<unsigned short> : public _default_make_arg {
+struct typeformat<unsigned short>
+    : public _default_make_arg,
+      public _masked_integral_convert<unsigned short, false> {
     static char_sequence<'H'> cs;
 };
 
 template<>
-struct typeformat<int> : public _default_make_arg {
+struct typeformat<int>
+    : public _default_make_arg,
+      public _checked_integral_convert<int> {
     static char_sequence<'i'> cs;
 };
 
 template<>
-struct typeformat<unsigned int> : public _default_make_arg {
+struct typeformat<unsigned int>
+    : public _default_make_arg,
+      public _masked_integral_convert<unsigned int, false> {
     static char_sequence<'I'> cs;
 };
 
 template<>
-struct typeformat<long> : public _default_make_arg {
+struct typeformat<long>
+    : public _default_make_arg,
+      public _checked_integral_convert<long> {
     static char_sequence<'l'> cs;
 };
 
 template<>
-struct typeformat<unsigned long> : public _default_make_arg {
+struct typeformat<unsigned long>
+    : public _default_make_arg,
+      public _masked_integral_convert<unsigned long, true> {
     static char_sequence<'k'> cs;
 };
 
 template<>
-struct typeformat<long long> : public _default_make_arg {
+struct typeformat<long long>
+    : public _default_make_arg,
+      public _checked_integral_convert<long long> {
     static char_sequence<'L'> cs;
 };
 
 template<>
-struct typeformat<unsigned long long> : public _default_make_arg {
+struct typeformat<unsigned long long>
+    : public _default_make_arg,
+      public _masked_integral_convert<unsigned long long, true> {
     static char_sequence<'K'> cs;
 };
 
 template<>
-struct typeformat<float> : public _default_make_arg {
+struct typeformat<float>
+    : public _default_make_arg,
+      public _floating_convert<float> {
     static char_sequence<'f'> cs;
 };
 
 template<>
-struct typeformat<double> : public _default_make_arg {
+struct typeformat<double>
+    : public _default_make_arg,
+      public _floating_convert<double> {
     static char_sequence<'d'> cs;
 };
 
 template<>
 struct typeformat<Py_complex> : public _default_make_arg {
     static char_sequence<'D'> cs;
+
+    static inline PyTypeObject *exact_type() {
+        return &PyComplex_Type;
+    }
+
+    static inline bool convert(PyObject *ob, Py_complex &out) {
+        out = PyComplex_AsCComplex(ob);
+        return !(out.real == -1.0 && PyErr_Occurred());
+    }
 };
 
 template<>
-struct typeformat<PyObject*> : public _default_make_arg {
+struct typeformat<PyObject*>
+    : public _default_make_arg,
+      public _object_convert<PyObject*> {
     static char_sequence<'O'> cs;
 };
 
 template<>
-struct typeformat<py::object> : public _default_make_arg {
+struct typeformat<py::object>
+    : public _default_make_arg,
+      public _object_convert<py::object> {
     static char_sequence<'O'> cs;
 };
 
 template<>
 struct typeformat<bool> : public _default_make_arg {
     static char_sequence<'p'> cs;
+
+    static inline PyTypeObject *exact_type() {
+        return &PyBool_Type;
+    }
+
+    static inline bool convert(PyObject *ob, bool &out) {
+        int truth = PyObject_IsTrue(ob);
+        if (truth < 0) {
+            return false;
+        }
+        out = truth;
+        return true;
+    }
 };
 
+/**
+   Convert an argument with `PyArg_Parse` and the format character for
+   `T`.
+
+   This is used for `typeformat` specializations which do not provide a
+   typed converter.
+*/
+template<typename T, typename = void>
+struct _argument_converter {
+    static inline bool convert(PyObject *ob, T &out) {
+        return apply(PyArg_Parse,
+                     std::tuple_cat(
+                         std::make_tuple(
+                             ob,
+                             char_sequence_to_array(
+                                 decltype(typeformat<T>::cs){}).data()),
+                         typeformat<T>::make_arg(&out)));
+    }
+};
+
+/**
+   Use the typed converter from `typeformat<T>` when it has one.
+*/
+template<typename T>
+struct _argument_converter<
+    T,
+    decltype(void(typeformat<T>::convert(std::declval<PyObject*>(),
+                                         std::declval<T&>())))> {
+    static inline bool convert(PyObject *ob, T &out) {
+        return typeformat<T>::convert(ob, out);
+    }
+};
+
+/**
+   Convert a Python object into a C++ value with the converter selected
+   from `typeformat<T>`.
+
+   @param ob  The object to convert.
+   @param out The value to write to.
+   @return    true on success, false with a Python exception set on
+              failure.
+*/
+template<typename T>
+inline bool convert_argument(PyObject *ob, T &out) {
+    return _argument_converter<T>::convert(ob, out);
+}
+
+/**
+   The flags for functions which take a C array of positional arguments,
+   `METH_FASTCALL` when it is available otherwise `METH_VARARGS`.
+*/
+constexpr int _meth_fastcall = HAVE_FASTCALL ? METH_FASTCALL : METH_VARARGS;
+
 /**
    Struct for extracting traits about the function being wrapped.
 */
@@ -128,24 +405,264 @@ struct _function_traits<R(Self, Args...)> {
     using parsed_args_type = std::tuple<Args...>;
 
     static constexpr std::size_t arity = sizeof...(Args);
-    static constexpr auto flags = arity ? METH_VARARGS : METH_NOARGS;
+    static constexpr int flags = (arity == 0) ? METH_NOARGS :
+                                 (arity == 1) ? METH_O :
+                                 _meth_fastcall;
+};
+
+/**
+   Releases the GIL for the lifetime of the object. This is
+   `Py_BEGIN_ALLOW_THREADS` and `Py_END_ALLOW_THREADS` as a scope guard
+   so that the GIL is reacquired even if the body throws.
+*/
+class _gil_released {
+private:
+    PyThreadState *state;
+
+public:
+    _gil_released() : state(PyEval_SaveThread()) {}
 
-    static inline auto fmtstr() {
-        return char_sequence_to_array(
-            char_sequence_cat(typeformat<Args>::cs...));
+    _gil_released(const _gil_released&) = delete;
+    _gil_released &operator=(const _gil_released&) = delete;
+
+    ~_gil_released() {
+        restore();
     }
 
-    template<typename T>
-    static inline auto make_args(T &&t) {
-        return make_args_impl(std::forward<T>(t),
-                              std::index_sequence_for<Args...>{});
+    /**
+       Reacquire the GIL now instead of at the end of the scope.
+    */
+    void restore() {
+        if (state) {
+            PyEval_RestoreThread(state);
+            state = nullptr;
+        }
+    }
+
+    /**
+       Reacquire the GIL and pass `result` through. Used as
+       `restore_after(f(...))` so that the GIL is held again before the
+       end of the full-expression, where the parameters of `f` are
+       destroyed.
+    */
+    template<typename R>
+    R restore_after(R &&result) {
+        restore();
+        return std::forward<R>(result);
+    }
+};
+
+/**
+   Call a function either holding the GIL or with the GIL released.
+*/
+template<bool nogil>
+struct _gil_policy {
+    template<typename F, typename... Args>
+    static inline decltype(auto) call(F &f, Args&&... args) {
+        return f(std::forward<Args>(args)...);
+    }
+};
+
+/**
+   Parameters taken by value, like a `py::buffer_view`, may need the GIL
+   to be destroyed. They live until the end of the full-expression which
+   calls `f`, so the GIL is reacquired inside of that expression.
+*/
+template<>
+struct _gil_policy<true> {
+private:
+    template<typename F, typename... Args>
+    using result_type = decltype(std::declval<F&>()(std::declval<Args>()...));
+
+public:
+    template<typename F, typename... Args>
+    static inline std::enable_if_t<
+        !std::is_void<result_type<F, Args...>>::value,
+        result_type<F, Args...>>
+    call(F &f, Args&&... args) {
+        // the result is constructed before the GIL is reacquired but it
+        // is only converted to a Python object once we hold the GIL again
+        _gil_released released;
+        return released.restore_after(f(std::forward<Args>(args)...));
+    }
+
+    template<typename F, typename... Args>
+    static inline std::enable_if_t<std::is_void<result_type<F, Args...>>::value>
+    call(F &f, Args&&... args) {
+        _gil_released released;
+        f(std::forward<Args>(args)...), released.restore();
+    }
+};
+
+/**
+   Convert the result of a wrapped function. A non-owning wrapper, like
+   `py::object`, returned by value holds a new reference just like a
+   returned `PyObject*`, so it is passed through unchanged.
+*/
+template<typename R>
+inline std::enable_if_t<std::is_base_of<py::object, std::decay_t<R>>::value &&
+                        !_is_owning_ref<std::decay_t<R>>::value,
+                        PyObject*>
+_convert_result(R &&result) {
+    return result;
+}
+
+template<typename R>
+inline std::enable_if_t<!std::is_base_of<py::object, std::decay_t<R>>::value ||
+                        _is_owning_ref<std::decay_t<R>>::value,
+                        PyObject*>
+_convert_result(R &&result) {
+    return to_python(std::forward<R>(result));
+}
+
+/**
+   Call the wrapped function and convert its result with `to_python`.
+   Functions which return `void` return `None`.
+
+   @tparam nogil Release the GIL while calling the function.
+*/
+template<typename R, bool nogil = false>
+struct _return_converter {
+    template<typename F, typename... Args>
+    static inline PyObject *call(F &f, Args&&... args) {
+        return _convert_result(_gil_policy<nogil>::call(
+                                   f,
+                                   std::forward<Args>(args)...));
     }
 
+    /**
+       Call the function, marking the end of the body on `timer` before
+       the result is converted.
+    */
+    template<typename Timer, typename F, typename... Args>
+    static inline PyObject *timed_call(Timer &timer, F &f, Args&&... args) {
+        R result = _gil_policy<nogil>::call(f, std::forward<Args>(args)...);
+        timer.called();
+        return _convert_result(std::forward<R>(result));
+    }
+
+    template<typename F, typename... Args>
+    static inline PyObject *timed_call(_automethod_no_stats::timer&,
+                                       F &f,
+                                       Args&&... args) {
+        return call(f, std::forward<Args>(args)...);
+    }
+};
+
+template<bool nogil>
+struct _return_converter<void, nogil> {
+    template<typename F, typename... Args>
+    static inline PyObject *call(F &f, Args&&... args) {
+        _gil_policy<nogil>::call(f, std::forward<Args>(args)...);
+        Py_RETURN_NONE;
+    }
+
+    template<typename Timer, typename F, typename... Args>
+    static inline PyObject *timed_call(Timer &timer, F &f, Args&&... args) {
+        _gil_policy<nogil>::call(f, std::forward<Args>(args)...);
+        timer.called();
+        Py_RETURN_NONE;
+    }
+};
+
+/**
+   Is `T` a borrowed Python object? These cannot be used without holding
+   the GIL.
+*/
+template<typename T>
+struct _is_python_object
+    : std::integral_constant<
+    bool,
+    std::is_same<std::decay_t<T>, PyObject*>::value ||
+    std::is_base_of<py::object, std::decay_t<T>>::value> {};
+
+template<typename F>
+struct _nogil_safe;
+
+/**
+   Check that a function may be called without the GIL: none of its
+   arguments, other than `self`, and not its return value may be Python
+   objects.
+*/
+template<typename R, typename Self, typename... Args>
+struct _nogil_safe<R(Self, Args...)> {
 private:
-    template<typename T, std::size_t... ns>
-    static inline auto make_args_impl(T &&t, std::index_sequence<ns...>) {
-        return std::tuple_cat(
-            typeformat<Args>::make_arg(std::get<ns>(t))...);
+    template<bool... bs>
+    struct none_of
+        : std::is_same<std::integer_sequence<bool, false, bs...>,
+                       std::integer_sequence<bool, bs..., false>> {};
+
+public:
+    static constexpr bool value =
+        none_of<_is_python_object<Args>::value...>::value &&
+        !_is_python_object<R>::value;
+};
+
+/**
+   Raise a `TypeError` for a call with the wrong number of arguments.
+
+   @param arity The number of arguments the function takes.
+   @param nargs The number of arguments given.
+*/
+inline void _bad_argument_count(std::size_t arity, Py_ssize_t nargs) {
+    PyErr_Format(PyExc_TypeError,
+                 "function takes exactly %zu argument%s (%zd given)",
+                 arity,
+                 arity == 1 ? "" : "s",
+                 nargs);
+}
+
+/**
+   Convert an array of exactly `arity` arguments and call `impl`.
+*/
+template<typename F, const F &impl, bool nogil = false>
+struct _automethod_invoke {
+private:
+    using traits = _function_traits<F>;
+
+    template<typename Timer, std::size_t... ns>
+    static inline PyObject *call(PyObject *self,
+                                 PyObject *const *args,
+                                 Timer &timer,
+                                 std::index_sequence<ns...>) {
+        typename traits::parsed_args_type parsed_args;
+
+        bool ok = true;
+        (void) std::initializer_list<bool>{
+            (ok = ok && convert_argument(args[ns],
+                                         std::get<ns>(parsed_args)))...};
+        if (!ok) {
+            return timer.finish(nullptr);
+        }
+        timer.parsed();
+        return timer.finish(
+            _return_converter<typename traits::return_type, nogil>::timed_call(
+                timer,
+                impl,
+                self,
+                std::move(std::get<ns>(parsed_args))...));
+    }
+
+public:
+    /**
+       @param self  The module or instance this is a method of.
+       @param args  The arguments to the method as a C array.
+       @param timer The timer from the stats policy.
+       @return      The result of calling our method.
+    */
+    template<typename Timer>
+    static inline PyObject *call(PyObject *self,
+                                 PyObject *const *args,
+                                 Timer &timer) {
+        return call(self,
+                    args,
+                    timer,
+                    std::make_index_sequence<traits::arity>{});
+    }
+
+    static inline PyObject *call(PyObject *self, PyObject *const *args) {
+        _automethod_no_stats::timer timer;
+        return call(self, args, timer);
     }
 };
 
@@ -153,78 +670,720 @@ private:
    Struct which provides a single function `f` which is the actual
    implementation of `_automethod_wrapper` to use. This is implemented
    as a struct to allow for partial template specialization to optimize
-   for the `METH_NOARGS` case.
+   for the `METH_NOARGS` and `METH_O` cases.
+
+   Each argument is converted with the typed converter for its parameter
+   type which is selected at compile time from `typeformat`.
+
+   @tparam Stats The stats policy, `_automethod_no_stats` or
+                 `_automethod_timed_stats`.
 */
-template<std::size_t arity, typename F, const F &impl>
+template<std::size_t arity,
+         typename F,
+         const F &impl,
+         bool nogil,
+         typename Stats>
 struct _automethodwrapper_impl {
-    static inline PyObject *f(PyObject *self, PyObject *args) {
-        using f = _function_traits<F>;
-        typename f::parsed_args_type parsed_args;
+public:
+    /**
+       Convert the arguments and call `impl`.
 
-        if (!apply(PyArg_ParseTuple,
-                   std::tuple_cat(std::make_tuple(args, f::fmtstr().data()),
-                                  f::make_args(tuple_refs(parsed_args))))) {
-            return nullptr;
+       @param self  The module or instance this is a method of.
+       @param args  The arguments to the method as a C array.
+       @param nargs The number of arguments.
+       @return      The result of calling our method.
+    */
+    static inline PyObject *call(PyObject *self,
+                                 PyObject *const *args,
+                                 Py_ssize_t nargs) {
+        auto timer = Stats::template start<F, impl>();
+        if (nargs != static_cast<Py_ssize_t>(arity)) {
+            _bad_argument_count(arity, nargs);
+            return timer.finish(nullptr);
         }
-        return apply(impl, std::tuple_cat(std::make_tuple(self), parsed_args));
+        return _automethod_invoke<F, impl, nogil>::call(self, args, timer);
+    }
+
+#if HAVE_FASTCALL
+    /**
+       The `METH_FASTCALL` entry point.
+    */
+    static PyObject *f(PyObject *self,
+                       PyObject *const *args,
+                       Py_ssize_t nargs) {
+        return call(self, args, nargs);
     }
+#else
+    /**
+       The `METH_VARARGS` entry point for versions of Python without
+       `METH_FASTCALL`.
+    */
+    static PyObject *f(PyObject *self, PyObject *args) {
+        return call(self,
+                    reinterpret_cast<PyTupleObject*>(args)->ob_item,
+                    PyTuple_GET_SIZE(args));
+    }
+#endif // HAVE_FASTCALL
 };
 
 /**
    `METH_NOARGS` handler for `_automethodwrapper_impl`, hit when
    `arity == 0`.
 */
-template<typename F, const F &impl>
-struct _automethodwrapper_impl<0, F, impl> {
-    static inline PyObject *f(PyObject *self, PyObject *args) {
-        return impl(self);
+template<typename F, const F &impl, bool nogil, typename Stats>
+struct _automethodwrapper_impl<0, F, impl, nogil, Stats> {
+private:
+    using traits = _function_traits<F>;
+
+public:
+    static PyObject *f(PyObject *self, PyObject*) {
+        auto timer = Stats::template start<F, impl>();
+        timer.parsed();
+        return timer.finish(
+            _return_converter<typename traits::return_type, nogil>::timed_call(
+                timer,
+                impl,
+                self));
     }
 };
 
 /**
-   The actual funtion that will be registered with the automatically
-   created PyMethodDef. This has the signature expected for a python
-   function and will handle unpacking the arguments.
+   `METH_O` handler for `_automethodwrapper_impl`, hit when `arity == 1`.
+   The argument is passed directly to the typed converter.
+*/
+template<typename F, const F &impl, bool nogil, typename Stats>
+struct _automethodwrapper_impl<1, F, impl, nogil, Stats> {
+private:
+    using traits = _function_traits<F>;
+
+public:
+    static PyObject *f(PyObject *self, PyObject *arg) {
+        auto timer = Stats::template start<F, impl>();
+        std::tuple_element_t<0, typename traits::parsed_args_type> parsed;
+        if (!convert_argument(arg, parsed)) {
+            return timer.finish(nullptr);
+        }
+        timer.parsed();
+        return timer.finish(
+            _return_converter<typename traits::return_type, nogil>::timed_call(
+                timer,
+                impl,
+                self,
+                std::move(parsed)));
+    }
+};
 
-   @param self The module or instance this is a method of.
-   @param args The arguments to the method as a `PyTupleObject*`.
-   @return     The result of calling our method.
+/**
+   The wrapper whose `f` will be registered with the automatically
+   created PyMethodDef. `f` has the signature expected for a python
+   function with the calling convention given by
+   `_function_traits<F>::flags` and will handle unpacking the arguments.
+
+   @tparam nogil Release the GIL while calling `impl`. The arguments are
+                 converted and the result is boxed while holding the GIL.
+   @tparam Stats The stats policy. `automethod` uses
+                 `_automethod_timed_stats` when `LIBPY_AUTOMETHOD_STATS`
+                 is defined, otherwise nothing is recorded.
+*/
+template<typename F,
+         const F &impl,
+         bool nogil = false,
+         typename Stats = _automethod_no_stats>
+struct _automethodwrapper
+    : public _automethodwrapper_impl<_function_traits<F>::arity,
+                                     F,
+                                     impl,
+                                     nogil,
+                                     Stats> {
+    static_assert(!nogil || _nogil_safe<F>::value,
+                  "functions which release the GIL may not take or return"
+                  " Python objects");
+};
+
+/**
+   Check an argument against `typeformat<T>::exact_type()`.
+
+   Types whose `typeformat` has an `exact_type` of nullptr accept any
+   object.
+*/
+template<typename T, typename = void>
+struct _exact_type_check {
+    static inline bool matches(PyObject *ob) {
+        PyTypeObject *type = typeformat<T>::exact_type();
+        return !type || Py_TYPE(ob) == type;
+    }
+};
+
+/**
+   Use `typeformat<T>::exact_match` for types which accept more than one
+   exact type.
+*/
+template<typename T>
+struct _exact_type_check<
+    T,
+    decltype(void(typeformat<T>::exact_match(std::declval<PyObject*>())))> {
+    static inline bool matches(PyObject *ob) {
+        return typeformat<T>::exact_match(ob);
+    }
+};
+
+/**
+   Check if an argument's type is exactly the type expected for `T`,
+   without converting it.
+*/
+template<typename T>
+inline bool _exact_type_matches(PyObject *ob) {
+    return _exact_type_check<T>::matches(ob);
+}
+
+/**
+   One function of an `automethod_overloads` set.
+
+   @tparam Stats The stats policy. Each overload is recorded in its own
+                 slot under the name of the set.
+*/
+template<typename F, const F &impl, typename Stats = _automethod_no_stats>
+struct _overload {
+private:
+    using traits = _function_traits<F>;
+    static constexpr std::size_t arity = traits::arity;
+
+    template<std::size_t... ns>
+    static inline bool matches(PyObject *const *args,
+                               std::index_sequence<ns...>) {
+        bool ok = true;
+        (void) std::initializer_list<bool>{
+            (ok = ok && _exact_type_matches<
+             std::tuple_element_t<ns, typename traits::parsed_args_type>>(
+                 args[ns]))...};
+        return ok;
+    }
+
+public:
+    /**
+       Check if this overload accepts the given arguments. This never
+       raises a Python exception.
+    */
+    static inline bool matches(PyObject *const *args, Py_ssize_t nargs) {
+        return nargs == static_cast<Py_ssize_t>(arity) &&
+            matches(args, std::make_index_sequence<arity>{});
+    }
+
+    static inline PyObject *call(PyObject *self, PyObject *const *args) {
+        auto timer = Stats::template start<F, impl>();
+        return _automethod_invoke<F, impl>::call(self, args, timer);
+    }
+
+    static inline void register_name(const char *name) {
+        Stats::template register_name<F, impl>(name);
+    }
+};
+
+/**
+   Raise a `TypeError` for a call which matched none of the overloads.
+*/
+inline void _no_matching_overload(PyObject *const *args, Py_ssize_t nargs) {
+    std::string types;
+    for (Py_ssize_t n = 0; n < nargs; ++n) {
+        if (n) {
+            types += ", ";
+        }
+        types += Py_TYPE(args[n])->tp_name;
+    }
+    PyErr_Format(PyExc_TypeError,
+                 "no overload accepts arguments of type (%s)",
+                 types.c_str());
+}
+
+/**
+   The wrapper for `automethod_overloads`.
+
+   The overloads are tried in the order they were given. Whether an
+   overload matches is decided by the argument count, which is known at
+   compile time for each overload, and then by comparing the argument
+   types against the exact types from `typeformat`. Only the selected
+   overload converts its arguments so no Python exceptions are raised
+   and cleared while searching.
+*/
+template<typename... Os>
+struct _automethodwrapper_overloads {
+private:
+    template<typename... Ts>
+    struct dispatch;
+
+    template<typename T, typename... Ts>
+    struct dispatch<T, Ts...> {
+        static inline PyObject *call(PyObject *self,
+                                     PyObject *const *args,
+                                     Py_ssize_t nargs) {
+            if (T::matches(args, nargs)) {
+                return T::call(self, args);
+            }
+            return dispatch<Ts...>::call(self, args, nargs);
+        }
+    };
+
+    template<typename End>
+    struct dispatch<End> {
+        static inline PyObject *call(PyObject*,
+                                     PyObject *const *args,
+                                     Py_ssize_t nargs) {
+            _no_matching_overload(args, nargs);
+            return nullptr;
+        }
+    };
+
+    // the final dispatch is selected by the trailing `void`
+    using dispatcher = dispatch<Os..., void>;
+
+public:
+    static constexpr int flags = _meth_fastcall;
+
+    /**
+       Register every overload with the stats policy.
+
+       @param name The name of the set.
+       @return     `name`.
+    */
+    static inline const char *register_name(const char *name) {
+        (void) std::initializer_list<int>{(Os::register_name(name), 0)...};
+        return name;
+    }
+
+#if HAVE_FASTCALL
+    /**
+       The `METH_FASTCALL` entry point.
+    */
+    static PyObject *f(PyObject *self,
+                       PyObject *const *args,
+                       Py_ssize_t nargs) {
+        return dispatcher::call(self, args, nargs);
+    }
+#else
+    /**
+       The `METH_VARARGS` entry point for versions of Python without
+       `METH_FASTCALL`.
+    */
+    static PyObject *f(PyObject *self, PyObject *args) {
+        return dispatcher::call(
+            self,
+            reinterpret_cast<PyTupleObject*>(args)->ob_item,
+            PyTuple_GET_SIZE(args));
+    }
+#endif // HAVE_FASTCALL
+};
+
+/**
+   A parameter with a default value which is used when the argument is
+   not passed.
+
+   @see default_arg
+*/
+template<typename Name, typename T>
+struct _defaulted_parameter {
+    T value;
+};
+
+/**
+   Give a parameter of a function wrapped with `automethod_kw` a default
+   value, for example: `default_arg("b"_kw, 1)`.
+
+   @param name  The name of the parameter.
+   @param value The value to use when the argument is not passed.
+   @return      The parameter.
 */
-template<typename F, const F &impl>
-PyObject *_automethodwrapper(PyObject *self, PyObject *args) {
-    return _automethodwrapper_impl<_function_traits<F>::arity,
-                                   F,
-                                   impl>::f(self, args);
+template<typename Name, typename T>
+constexpr _defaulted_parameter<Name, T> default_arg(py::kwname<Name>,
+                                                     T value) {
+    return {value};
 }
 
-#define _libpy_automethod_def(name, f, doc)  (PyMethodDef {             \
-        name,                                                           \
-        (PyCFunction) pyutils::_automethodwrapper<decltype(f), f>,      \
-        pyutils::_function_traits<decltype(f)>::flags,                  \
+template<typename P>
+struct _parameter_name;
+
+template<typename Name>
+struct _parameter_name<py::kwname<Name>> {
+    using type = Name;
+};
+
+template<typename Name, typename T>
+struct _parameter_name<_defaulted_parameter<Name, T>> {
+    using type = Name;
+};
+
+/**
+   The names and default values for the parameters of a function wrapped
+   with `automethod_kw`.
+
+   @see parameters
+*/
+template<typename... Ps>
+struct parameter_list {
+    using kwnames = py::_kwnames<typename _parameter_name<Ps>::type...>;
+    static constexpr std::size_t size = sizeof...(Ps);
+
+    std::tuple<Ps...> params;
+};
+
+/**
+   Declare the parameters of a function wrapped with `automethod_kw`.
+
+   Each parameter is either a name, like `"a"_kw`, or a name with a
+   default value, like `default_arg("b"_kw, 1)`.
+
+   @param params The parameters in the order of the function arguments.
+   @return       The parameter list.
+*/
+template<typename... Ps>
+constexpr parameter_list<Ps...> parameters(Ps... params) {
+    return {std::make_tuple(params...)};
+}
+
+/**
+   Bind a keyword argument to the slot for its parameter.
+
+   The name is first looked up by identity, which is the common case
+   because keyword names in calls are interned, and then by string
+   equality.
+
+   @param slots The slots for each parameter.
+   @param names The interned names of the parameters.
+   @param nargs The number of positional arguments.
+   @param key   The name of the keyword argument.
+   @param value The value of the keyword argument.
+   @return      true on success, false with a Python exception set on
+                failure.
+*/
+inline bool _bind_keyword(PyObject **slots,
+                          PyObject *names,
+                          Py_ssize_t nargs,
+                          PyObject *key,
+                          PyObject *value) {
+    Py_ssize_t size = PyTuple_GET_SIZE(names);
+    Py_ssize_t ix = -1;
+
+    for (Py_ssize_t n = 0; n < size; ++n) {
+        if (PyTuple_GET_ITEM(names, n) == key) {
+            ix = n;
+            break;
+        }
+    }
+
+    if (ix < 0) {
+        if (!PyUnicode_Check(key)) {
+            PyErr_SetString(PyExc_TypeError, "keywords must be strings");
+            return false;
+        }
+        for (Py_ssize_t n = 0; n < size; ++n) {
+            if (!PyUnicode_Compare(PyTuple_GET_ITEM(names, n), key)) {
+                ix = n;
+                break;
+            }
+        }
+    }
+
+    if (ix < 0) {
+        PyErr_Format(PyExc_TypeError,
+                     "'%U' is an invalid keyword argument for this function",
+                     key);
+        return false;
+    }
+    if (ix < nargs || slots[ix]) {
+        PyErr_Format(PyExc_TypeError,
+                     "got multiple values for argument '%U'",
+                     key);
+        return false;
+    }
+
+    slots[ix] = value;
+    return true;
+}
+
+/**
+   Fill in an argument which was not passed. This fails because the
+   parameter has no default.
+*/
+template<typename Name, typename T>
+inline bool _fill_default(const py::kwname<Name>&, T&, PyObject *name) {
+    PyErr_Format(PyExc_TypeError, "missing required argument '%U'", name);
+    return false;
+}
+
+/**
+   Fill in an argument which was not passed with its default value.
+*/
+template<typename Name, typename D, typename T>
+inline bool _fill_default(const _defaulted_parameter<Name, D> &param,
+                          T &out,
+                          PyObject*) {
+    out = param.value;
+    return true;
+}
+
+/**
+   The wrapper for `automethod_kw`. `f` has the signature expected for a
+   python function with the calling convention given by `flags` and will
+   bind the positional and keyword arguments to the parameters in
+   `params` before converting them.
+
+   @tparam Stats The stats policy. Binding the arguments is timed as part
+                 of parsing.
+*/
+template<typename F,
+         const F &impl,
+         typename P,
+         const P &params,
+         typename Stats = _automethod_no_stats>
+struct _automethodwrapper_kw {
+private:
+    using traits = _function_traits<F>;
+    static constexpr std::size_t arity = traits::arity;
+
+    static_assert(P::size == arity,
+                  "the parameter list must name every argument");
+
+    using slots_type = std::array<PyObject*, arity>;
+
+    template<typename Timer, std::size_t... ns>
+    static inline PyObject *call(PyObject *self,
+                                 const slots_type &slots,
+                                 PyObject *names,
+                                 Timer &timer,
+                                 std::index_sequence<ns...>) {
+        typename traits::parsed_args_type parsed_args;
+
+        bool ok = true;
+        (void) std::initializer_list<bool>{
+            (ok = ok && (slots[ns] ?
+                         convert_argument(slots[ns],
+                                          std::get<ns>(parsed_args)) :
+                         _fill_default(std::get<ns>(params.params),
+                                       std::get<ns>(parsed_args),
+                                       PyTuple_GET_ITEM(names, ns))))...};
+        if (!ok) {
+            return timer.finish(nullptr);
+        }
+        timer.parsed();
+        return timer.finish(
+            _return_converter<typename traits::return_type>::timed_call(
+                timer,
+                impl,
+                self,
+                std::move(std::get<ns>(parsed_args))...));
+    }
+
+    static inline PyObject *bind_positional(slots_type &slots,
+                                            PyObject *const *args,
+                                            Py_ssize_t nargs) {
+        if (nargs > static_cast<Py_ssize_t>(arity)) {
+            PyErr_Format(PyExc_TypeError,
+                         "function takes at most %zu argument%s (%zd given)",
+                         arity,
+                         arity == 1 ? "" : "s",
+                         nargs);
+            return nullptr;
+        }
+
+        PyObject *names = P::kwnames::get();
+        if (!names) {
+            return nullptr;
+        }
+
+        for (Py_ssize_t n = 0; n < nargs; ++n) {
+            slots[n] = args[n];
+        }
+        return names;
+    }
+
+public:
+    static constexpr int flags = _meth_fastcall | METH_KEYWORDS;
+
+#if HAVE_FASTCALL
+    /**
+       The `METH_FASTCALL | METH_KEYWORDS` entry point.
+    */
+    static PyObject *f(PyObject *self,
+                       PyObject *const *args,
+                       Py_ssize_t nargs,
+                       PyObject *kwnames) {
+        auto timer = Stats::template start<F, impl>();
+        slots_type slots{};
+        PyObject *names = bind_positional(slots, args, nargs);
+        if (!names) {
+            return timer.finish(nullptr);
+        }
+
+        if (kwnames) {
+            Py_ssize_t nkwargs = PyTuple_GET_SIZE(kwnames);
+            for (Py_ssize_t n = 0; n < nkwargs; ++n) {
+                if (!_bind_keyword(slots.data(),
+                                   names,
+                                   nargs,
+                                   PyTuple_GET_ITEM(kwnames, n),
+                                   args[nargs + n])) {
+                    return timer.finish(nullptr);
+                }
+            }
+        }
+
+        return call(self,
+                    slots,
+                    names,
+                    timer,
+                    std::make_index_sequence<arity>{});
+    }
+#else
+    /**
+       The `METH_VARARGS | METH_KEYWORDS` entry point for versions of
+       Python without `METH_FASTCALL`.
+    */
+    static PyObject *f(PyObject *self, PyObject *args, PyObject *kwargs) {
+        auto timer = Stats::template start<F, impl>();
+        Py_ssize_t nargs = PyTuple_GET_SIZE(args);
+        slots_type slots{};
+        PyObject *names = bind_positional(
+            slots,
+            reinterpret_cast<PyTupleObject*>(args)->ob_item,
+            nargs);
+        if (!names) {
+            return timer.finish(nullptr);
+        }
+
+        if (kwargs) {
+            Py_ssize_t pos = 0;
+            PyObject *key;
+            PyObject *value;
+            while (PyDict_Next(kwargs, &pos, &key, &value)) {
+                if (!_bind_keyword(slots.data(), names, nargs, key, value)) {
+                    return timer.finish(nullptr);
+                }
+            }
+        }
+
+        return call(self,
+                    slots,
+                    names,
+                    timer,
+                    std::make_index_sequence<arity>{});
+    }
+#endif // HAVE_FASTCALL
+};
+
+#define _libpy_automethod_def_impl(name, func, doc, nogil)  (PyMethodDef { \
+        _LIBPY_AUTOMETHOD_STATS_POLICY::register_name<decltype(func),   \
+                                                      func>(name),      \
+        (PyCFunction) (void (*)(void))                                  \
+        pyutils::_automethodwrapper<decltype(func),                     \
+                                    func,                               \
+                                    nogil,                              \
+                                    _LIBPY_AUTOMETHOD_STATS_POLICY>::f, \
+        pyutils::_function_traits<decltype(func)>::flags,               \
         doc,                                                            \
     })
+#define _libpy_automethod_def(name, func, doc)          \
+    _libpy_automethod_def_impl(name, func, doc, false)
+
+#define _libpy_automethod_2(func, doc) _libpy_automethod_def(#func, func, doc)
+#define _libpy_automethod_1(func) _libpy_automethod_2(func, nullptr)
+#define _libpy_automethod_dispatch(n, func, doc, macro, ...)  macro
+
+#define _libpy_named_automethod_3(name, func, doc)      \
+    _libpy_automethod_def(name, func, doc)
+#define _libpy_named_automethod_2(name, func)           \
+    _libpy_named_automethod_3(name, func, nullptr)
+#define _libpy_named_automethod_dispatch(name, func, doc, macro, ...)  macro
+
+#define _libpy_automethod_nogil_2(func, doc)                    \
+    _libpy_automethod_def_impl(#func, func, doc, true)
+#define _libpy_automethod_nogil_1(func) _libpy_automethod_nogil_2(func, nullptr)
 
-#define _libpy_automethod_2(f, doc) (PyMethodDef {                      \
-        #f,                                                             \
-        (PyCFunction) pyutils::_automethodwrapper<decltype(f), f>,      \
-        pyutils::_function_traits<decltype(f)>::flags,                  \
+#define _libpy_named_automethod_nogil_3(name, func, doc)        \
+    _libpy_automethod_def_impl(name, func, doc, true)
+#define _libpy_named_automethod_nogil_2(name, func)             \
+    _libpy_named_automethod_nogil_3(name, func, nullptr)
+
+#define _libpy_overload(func)                                    \
+    pyutils::_overload<decltype(func), func, _LIBPY_AUTOMETHOD_STATS_POLICY>
+#define _libpy_overloads_1(a) _libpy_overload(a)
+#define _libpy_overloads_2(a, ...)                              \
+    _libpy_overload(a), _libpy_overloads_1(__VA_ARGS__)
+#define _libpy_overloads_3(a, ...)                              \
+    _libpy_overload(a), _libpy_overloads_2(__VA_ARGS__)
+#define _libpy_overloads_4(a, ...)                              \
+    _libpy_overload(a), _libpy_overloads_3(__VA_ARGS__)
+#define _libpy_overloads_5(a, ...)                              \
+    _libpy_overload(a), _libpy_overloads_4(__VA_ARGS__)
+#define _libpy_overloads_6(a, ...)                              \
+    _libpy_overload(a), _libpy_overloads_5(__VA_ARGS__)
+#define _libpy_overloads_7(a, ...)                              \
+    _libpy_overload(a), _libpy_overloads_6(__VA_ARGS__)
+#define _libpy_overloads_8(a, ...)                              \
+    _libpy_overload(a), _libpy_overloads_7(__VA_ARGS__)
+#define _libpy_overloads_dispatch(_1, _2, _3, _4, _5, _6, _7, _8, macro, ...) \
+    macro
+#define _libpy_overloads(...)                                           \
+    _libpy_overloads_dispatch(__VA_ARGS__,                              \
+                              _libpy_overloads_8,                       \
+                              _libpy_overloads_7,                       \
+                              _libpy_overloads_6,                       \
+                              _libpy_overloads_5,                       \
+                              _libpy_overloads_4,                       \
+                              _libpy_overloads_3,                       \
+                              _libpy_overloads_2,                       \
+                              _libpy_overloads_1)(__VA_ARGS__)
+
+#define _libpy_automethod_overloads_def(name, doc, ...)  (PyMethodDef { \
+        pyutils::_automethodwrapper_overloads<                          \
+            _libpy_overloads(__VA_ARGS__)>::register_name(name),        \
+        (PyCFunction) (void (*)(void))                                  \
+        pyutils::_automethodwrapper_overloads<                          \
+            _libpy_overloads(__VA_ARGS__)>::f,                          \
+        pyutils::_automethodwrapper_overloads<                          \
+            _libpy_overloads(__VA_ARGS__)>::flags,                      \
         doc,                                                            \
     })
-#define _libpy_automethod_1(f) _libpy_automethod_2(f, nullptr)
-#define _libpy_automethod_dispatch(n, f, doc, macro, ...)  macro
 
-#define _libpy_named_automethod_3(name, f, doc) (PyMethodDef {          \
-        name,                                                           \
-        (PyCFunction) pyutils::_automethodwrapper<decltype(f), f>,      \
-        METH_VARARGS,                                                   \
+#define _libpy_automethod_kw_def(name, func, params, doc)  (PyMethodDef { \
+        _LIBPY_AUTOMETHOD_STATS_POLICY::register_name<decltype(func),   \
+                                                      func>(name),      \
+        (PyCFunction) (void (*)(void))                                  \
+        pyutils::_automethodwrapper_kw<decltype(func),                  \
+                                       func,                            \
+                                       std::decay_t<decltype(params)>,  \
+                                       params,                          \
+                                       _LIBPY_AUTOMETHOD_STATS_POLICY>::f, \
+        pyutils::_automethodwrapper_kw<decltype(func),                  \
+                                       func,                            \
+                                       std::decay_t<decltype(params)>,  \
+                                       params>::flags,                  \
         doc,                                                            \
     })
-#define _libpy_named_automethod_2(name, f) _libpy_automethod_2(name, f, nullptr)
-#define _libpy_named_automethod_dispatch(n, f, doc, macro, ...)  macro
+
+#define _libpy_automethod_kw_3(func, params, doc)       \
+    _libpy_automethod_kw_def(#func, func, params, doc)
+#define _libpy_automethod_kw_2(func, params)            \
+    _libpy_automethod_kw_3(func, params, nullptr)
+#define _libpy_automethod_kw_dispatch(func, params, doc, macro, ...)  macro
+
+#define _libpy_named_automethod_kw_4(name, func, params, doc)   \
+    _libpy_automethod_kw_def(name, func, params, doc)
+#define _libpy_named_automethod_kw_3(name, func, params)        \
+    _libpy_named_automethod_kw_4(name, func, params, nullptr)
+#define _libpy_named_automethod_kw_dispatch(name, func, params, doc, macro, ...) \
+    macro
 
     /**
        Wrap a C++ function as a python `PyMethodDef` structure.
 
+       The arguments are converted with `typeformat` and the result is
+       converted with `to_python`, so the function may return any
+       convertible type. A returned `PyObject*` or non-owning wrapper,
+       like `py::object`, must be a new reference.
+
+       If `LIBPY_AUTOMETHOD_STATS` is defined before including libpy, the
+       wrapper counts calls and errors and times each phase of the call.
+       The results are read with `pyutils::automethod_stats`.
+
        @param func The function to wrap.
        @param doc  The docstring to use for the function. If this is omitted
                    the docstring will `be None`.
@@ -249,7 +1408,108 @@ PyObject *_automethodwrapper(PyObject *self, PyObject *args) {
        @return     A `PyMethodDef` structure for the given function.
     */
 #define named_automethod(...)                                           \
-    _libpy_named_automethod_dispatch(name,##__VA_ARGS__,                \
+    _libpy_named_automethod_dispatch(__VA_ARGS__,                       \
                                      _libpy_named_automethod_3(__VA_ARGS__),  \
-                                     _libpy_named_automethod_3(__VA_ARGS__))
+                                     _libpy_named_automethod_2(__VA_ARGS__))
+
+    /**
+       Wrap a C++ function as a python `PyMethodDef` structure which
+       accepts keyword arguments.
+
+       @param func   The function to wrap.
+       @param params The names and default values of the parameters,
+                     see `pyutils::parameters`. This must be a namespace
+                     scope `constexpr` variable so that it may be used as
+                     a template argument.
+       @param doc    The docstring to use for the function. If this is
+                     omitted the docstring will be `None`.
+       @return       A `PyMethodDef` structure for the given function.
+    */
+#define automethod_kw(...)                                              \
+    _libpy_automethod_kw_dispatch(__VA_ARGS__,                          \
+                                  _libpy_automethod_kw_3(__VA_ARGS__),  \
+                                  _libpy_automethod_kw_2(__VA_ARGS__))
+
+    /**
+       Wrap a C++ function as a python `PyMethodDef` structure which
+       accepts keyword arguments but give the python function an explicit
+       name.
+
+       @param name   The name for the function as it will be seen from
+                     python.
+       @param func   The function to wrap.
+       @param params The names and default values of the parameters,
+                     see `pyutils::parameters`.
+       @param doc    The docstring to use for the function. If this is
+                     omitted the docstring will be `None`.
+       @return       A `PyMethodDef` structure for the given function.
+    */
+#define named_automethod_kw(...)                                        \
+    _libpy_named_automethod_kw_dispatch(                                \
+        __VA_ARGS__,                                                    \
+        _libpy_named_automethod_kw_4(__VA_ARGS__),                      \
+        _libpy_named_automethod_kw_3(__VA_ARGS__))
+
+    /**
+       Wrap up to 8 C++ functions as a single python `PyMethodDef`
+       structure which calls the first function whose argument count and
+       argument types match the arguments.
+
+       Each argument type must have a `typeformat` with an `exact_type`.
+       An argument only matches when its type is exactly that type, so for
+       example a `bool` does not select an `int` overload.
+
+       @param name The name for the function as it will be seen from
+                   python.
+       @param ...  The functions to wrap, in the order they are tried.
+       @return     A `PyMethodDef` structure for the given functions.
+    */
+#define automethod_overloads(name, ...)                                 \
+    _libpy_automethod_overloads_def(name, nullptr, __VA_ARGS__)
+
+    /**
+       `automethod_overloads` with a docstring.
+
+       @param name The name for the function as it will be seen from
+                   python.
+       @param doc  The docstring to use for the function.
+       @param ...  The functions to wrap, in the order they are tried.
+       @return     A `PyMethodDef` structure for the given functions.
+    */
+#define automethod_overloads_doc(name, doc, ...)                \
+    _libpy_automethod_overloads_def(name, doc, __VA_ARGS__)
+
+    /**
+       Wrap a C++ function like `automethod` but release the GIL while the
+       function runs.
+
+       The arguments are converted before the GIL is released and the
+       result is converted after it is reacquired. The function may not
+       take or return Python objects, which is checked at compile time.
+       `self` is still passed but must not be used as a Python object.
+
+       @param func The function to wrap.
+       @param doc  The docstring to use for the function. If this is omitted
+                   the docstring will be `None`.
+       @return     A `PyMethodDef` structure for the given function.
+    */
+#define automethod_nogil(...)                                           \
+    _libpy_automethod_dispatch(,##__VA_ARGS__,                          \
+                               _libpy_automethod_nogil_2(__VA_ARGS__),  \
+                               _libpy_automethod_nogil_1(__VA_ARGS__))
+
+    /**
+       `named_automethod` which releases the GIL while the function runs.
+
+       @param name The name for the function as it will be seen from python.
+       @param func The function to wrap.
+       @param doc  The docstring to use for the function. If this is omitted
+                   the docstring will be `None`.
+       @return     A `PyMethodDef` structure for the given function.
+    */
+#define named_automethod_nogil(...)                                     \
+    _libpy_named_automethod_dispatch(                                   \
+        __VA_ARGS__,                                                    \
+        _libpy_named_automethod_nogil_3(__VA_ARGS__),                   \
+        _libpy_named_automethod_nogil_2(__VA_ARGS__))
 }
@@ -0,0 +1,216 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <Python.h>
+
+namespace pyutils {
+/**
+   A log-scaled histogram of durations in nanoseconds.
+
+   Bucket 0 counts durations of 0ns and bucket `n` counts durations in
+   `[2 ** (n - 1), 2 ** n)`. The last bucket also holds anything longer.
+   Recording is lock-free and may happen from any thread.
+
+   Histograms are only used with static storage duration where the
+   counters are zero initialized.
+*/
+struct automethod_histogram {
+    static constexpr std::size_t nbuckets = 48;
+
+    std::atomic<std::uint64_t> total_ns;
+    std::atomic<std::uint64_t> buckets[nbuckets];
+
+    static inline std::size_t bucket(std::uint64_t ns) {
+        if (!ns) {
+            return 0;
+        }
+        std::size_t ix = 64 - __builtin_clzll(ns);
+        return ix < nbuckets ? ix : nbuckets - 1;
+    }
+
+    inline void record(std::uint64_t ns) {
+        total_ns.fetch_add(ns, std::memory_order_relaxed);
+        buckets[bucket(ns)].fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+/**
+   The statistics for a single function wrapped with `automethod` while
+   `LIBPY_AUTOMETHOD_STATS` is defined.
+*/
+struct automethod_stats_slot {
+    /**
+       The name of the function, set when the `PyMethodDef` is created.
+    */
+    const char *name;
+
+    /**
+       The next registered slot.
+    */
+    automethod_stats_slot *next;
+
+    std::atomic<bool> registered;
+    std::atomic<std::uint64_t> calls;
+    std::atomic<std::uint64_t> errors;
+
+    /**
+       Time spent converting the arguments.
+    */
+    automethod_histogram parse;
+
+    /**
+       Time spent in the C++ function.
+    */
+    automethod_histogram body;
+
+    /**
+       Time spent converting the result to a Python object.
+    */
+    automethod_histogram convert;
+};
+
+/**
+   Add a slot to the set reported by `automethod_stats`. Slots are never
+   removed.
+*/
+void _register_automethod_stats(automethod_stats_slot *slot);
+
+/**
+   Collect the statistics for every function wrapped with `automethod`,
+   `automethod_kw` or `automethod_overloads` in a translation unit
+   compiled with `LIBPY_AUTOMETHOD_STATS`. `automethod_vectorized` and
+   the constructors made by `py::type::builder` are not recorded.
+
+   The result maps the function's name to a dict with the keys:
+   `calls`, `errors`, `parse`, `body` and `convert`. The timing entries
+   are dicts of `total_ns` and `histogram`, a list where item `n` is the
+   number of calls which took between `2 ** (n - 1)` and `2 ** n`
+   nanoseconds. Trailing empty buckets are omitted.
+
+   Functions registered under the same name, like `__len__` on two
+   types or each function of an overload set, are added together. Calls
+   which fail while parsing their arguments are counted but not timed,
+   and calls which match no overload are not counted. The counters are
+   read without stopping other threads so the values may be from
+   slightly different moments.
+
+   This may be exposed to Python with
+   `named_automethod("automethod_stats", pyutils::automethod_stats)`.
+
+   @param self Unused, this allows the function to be wrapped with
+               `automethod`.
+   @return     A new reference to the dict, or nullptr with a Python
+               exception set.
+*/
+PyObject *automethod_stats(PyObject *self = nullptr);
+
+/**
+   The stats policy used when `LIBPY_AUTOMETHOD_STATS` is not defined.
+   Every member is empty so the wrapper compiles to the same code as if
+   there were no policy.
+*/
+struct _automethod_no_stats {
+    struct timer {
+        inline void parsed() {}
+        inline void called() {}
+        inline PyObject *finish(PyObject *result) {
+            return result;
+        }
+    };
+
+    template<typename F, const F &impl>
+    static inline timer start() {
+        return {};
+    }
+
+    template<typename F, const F &impl>
+    static constexpr const char *register_name(const char *name) {
+        return name;
+    }
+};
+
+/**
+   The stats policy used when `LIBPY_AUTOMETHOD_STATS` is defined. Each
+   wrapped function gets its own slot keyed by the function.
+*/
+struct _automethod_timed_stats {
+private:
+    template<typename F, const F &impl>
+    struct slot_for {
+        static automethod_stats_slot value;
+    };
+
+    using clock = std::chrono::steady_clock;
+
+    static inline std::uint64_t elapsed_ns(clock::time_point start,
+                                           clock::time_point stop) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            stop - start).count();
+    }
+
+public:
+    class timer {
+    private:
+        automethod_stats_slot &slot;
+        clock::time_point started;
+        clock::time_point parsed_at;
+        clock::time_point called_at;
+        bool timed = false;
+
+    public:
+        explicit timer(automethod_stats_slot &slot)
+            : slot(slot),
+              started(clock::now()) {}
+
+        inline void parsed() {
+            parsed_at = clock::now();
+        }
+
+        inline void called() {
+            called_at = clock::now();
+            timed = true;
+        }
+
+        inline PyObject *finish(PyObject *result) {
+            slot.calls.fetch_add(1, std::memory_order_relaxed);
+            if (!result) {
+                slot.errors.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (timed) {
+                clock::time_point finished = clock::now();
+                slot.parse.record(elapsed_ns(started, parsed_at));
+                slot.body.record(elapsed_ns(parsed_at, called_at));
+                slot.convert.record(elapsed_ns(called_at, finished));
+            }
+            return result;
+        }
+    };
+
+    template<typename F, const F &impl>
+    static inline timer start() {
+        return timer(slot_for<F, impl>::value);
+    }
+
+    template<typename F, const F &impl>
+    static inline const char *register_name(const char *name) {
+        automethod_stats_slot &slot = slot_for<F, impl>::value;
+        slot.name = name;
+        if (!slot.registered.exchange(true)) {
+            _register_automethod_stats(&slot);
+        }
+        return name;
+    }
+};
+
+template<typename F, const F &impl>
+automethod_stats_slot _automethod_timed_stats::slot_for<F, impl>::value;
+}
+
+#ifdef LIBPY_AUTOMETHOD_STATS
+#define _LIBPY_AUTOMETHOD_STATS_POLICY pyutils::_automethod_timed_stats
+#else
+#define _LIBPY_AUTOMETHOD_STATS_POLICY pyutils::_automethod_no_stats
+#endif
@@ -0,0 +1,346 @@
+#pragma once
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <Python.h>
+
+#include "libpy/automethod.h"
+#include "libpy/buffer.h"
+#include "libpy/object.h"
+#include "libpy/to_python.h"
+
+namespace pyutils {
+/**
+   One argument to a vectorized function. This is either a scalar which
+   is broadcast to every element, or a contiguous array of values. Lists
+   and tuples are converted to an array up front; buffers of the correct
+   type are read in place.
+*/
+template<typename T>
+class _vectorized_arg {
+private:
+    T scalar;
+    std::unique_ptr<T[]> converted;
+    py::buffer_view<const T> view;
+
+    bool load_sequence(PyObject *ob) {
+        bool is_list = PyList_Check(ob);
+        Py_ssize_t len = Py_SIZE(ob);
+        converted.reset(new T[len]);
+
+        for (Py_ssize_t n = 0; n < len; ++n) {
+            // converters may run arbitrary code which could resize a list
+            if (is_list && PyList_GET_SIZE(ob) != len) {
+                PyErr_SetString(PyExc_RuntimeError,
+                                "list changed size during conversion");
+                return false;
+            }
+            PyObject *item = is_list ?
+                PyList_GET_ITEM(ob, n) :
+                PyTuple_GET_ITEM(ob, n);
+            if (!convert_argument(item, converted[n])) {
+                return false;
+            }
+        }
+
+        data = converted.get();
+        size = len;
+        stride = 1;
+        return true;
+    }
+
+    bool load_buffer(PyObject *ob) {
+        if (!view.acquire(ob)) {
+            return false;
+        }
+
+        data = view.data();
+        size = view.size();
+        stride = 1;
+        return true;
+    }
+
+public:
+    /**
+       The values, `size` values spaced `stride` apart.
+    */
+    const T *data = nullptr;
+
+    /**
+       The number of values, or -1 for a scalar.
+    */
+    Py_ssize_t size = -1;
+
+    /**
+       The distance between values, 0 for a scalar.
+    */
+    Py_ssize_t stride = 0;
+
+    _vectorized_arg() = default;
+    _vectorized_arg(const _vectorized_arg&) = delete;
+    _vectorized_arg &operator=(const _vectorized_arg&) = delete;
+
+    /**
+       Load the argument from a Python object.
+
+       @param ob The argument.
+       @return   true on success, false with a Python exception set on
+                 failure.
+    */
+    bool load(PyObject *ob) {
+        if (PyList_Check(ob) || PyTuple_Check(ob)) {
+            return load_sequence(ob);
+        }
+        if (PyObject_CheckBuffer(ob)) {
+            return load_buffer(ob);
+        }
+        if (!convert_argument(ob, scalar)) {
+            return false;
+        }
+        data = &scalar;
+        return true;
+    }
+
+    bool is_scalar() const {
+        return size < 0;
+    }
+
+    bool is_buffer() const {
+        return view.acquired();
+    }
+};
+
+/**
+   View a `bytearray` as a typed `memoryview`.
+
+   @param bytes  A new reference to the `bytearray`, this reference is
+                 stolen.
+   @param format The format character of the items.
+   @return       A new reference to the `memoryview` or nullptr with a
+                 Python exception set.
+*/
+inline PyObject *_as_typed_memoryview(PyObject *bytes, char format) {
+    py::tmpref<py::object> owned(bytes);
+    py::tmpref<py::object> view(PyMemoryView_FromObject(bytes));
+    if (!view.is_nonnull()) {
+        return nullptr;
+    }
+
+    const char fmt[] = {format, '\0'};
+    return PyObject_CallMethod(view, "cast", "s", fmt);
+}
+
+template<typename F>
+struct _vectorized_traits;
+
+template<typename R, typename... Args>
+struct _vectorized_traits<R(Args...)> {
+    static_assert(std::is_arithmetic<R>::value,
+                  "vectorized functions must return an arithmetic type");
+    static_assert(sizeof...(Args) > 0,
+                  "vectorized functions must take at least one argument");
+
+    using return_type = R;
+    using args_type = std::tuple<_vectorized_arg<std::decay_t<Args>>...>;
+    static constexpr std::size_t arity = sizeof...(Args);
+};
+
+/**
+   The wrapper for `automethod_vectorized`.
+
+   Each argument may be a scalar, a list or tuple, or a one dimensional
+   buffer. If every argument is a scalar the function is called once and
+   the result is returned. Otherwise all of the non-scalar arguments must
+   have the same length and the function is called once per element with
+   the scalars broadcast. The result is a `list`, or a `memoryview` of the
+   result type if any argument was a buffer.
+*/
+template<typename F, const F &impl>
+struct _automethodwrapper_vectorized {
+private:
+    using traits = _vectorized_traits<F>;
+    using R = typename traits::return_type;
+    using args_type = typename traits::args_type;
+    static constexpr std::size_t arity = traits::arity;
+
+    template<std::size_t... ns>
+    static inline void loop_contiguous(R *__restrict out,
+                                       Py_ssize_t len,
+                                       const args_type &args,
+                                       std::index_sequence<ns...>) {
+        // every argument has unit stride so this is a simple indexed loop
+        // the compiler may vectorize when `impl` is inlined
+        const auto ptrs = std::make_tuple(std::get<ns>(args).data...);
+        for (Py_ssize_t ix = 0; ix < len; ++ix) {
+            out[ix] = impl(std::get<ns>(ptrs)[ix]...);
+        }
+    }
+
+    template<std::size_t... ns>
+    static inline void loop_strided(R *__restrict out,
+                                    Py_ssize_t len,
+                                    const args_type &args,
+                                    std::index_sequence<ns...>) {
+        const auto ptrs = std::make_tuple(std::get<ns>(args).data...);
+        const Py_ssize_t strides[] = {std::get<ns>(args).stride...};
+        for (Py_ssize_t ix = 0; ix < len; ++ix) {
+            out[ix] = impl(std::get<ns>(ptrs)[ix * strides[ns]]...);
+        }
+    }
+
+    template<std::size_t... ns>
+    static inline PyObject *call(PyObject *const *args,
+                                 std::index_sequence<ns...> ixs) {
+        args_type loaded;
+
+        bool ok = true;
+        (void) std::initializer_list<bool>{
+            (ok = ok && std::get<ns>(loaded).load(args[ns]))...};
+        if (!ok) {
+            return nullptr;
+        }
+
+        Py_ssize_t len = -1;
+        bool all_contiguous = true;
+        bool any_buffer = false;
+        (void) std::initializer_list<bool>{
+            (ok = ok && check_size(std::get<ns>(loaded),
+                                   len,
+                                   all_contiguous,
+                                   any_buffer))...};
+        if (!ok) {
+            return nullptr;
+        }
+
+        if (len < 0) {
+            // all scalars
+            return to_python(impl(*std::get<ns>(loaded).data...));
+        }
+
+        if (any_buffer) {
+            PyObject *bytes = PyByteArray_FromStringAndSize(nullptr,
+                                                            len * sizeof(R));
+            if (!bytes) {
+                return nullptr;
+            }
+            R *out = reinterpret_cast<R*>(PyByteArray_AS_STRING(bytes));
+            if (all_contiguous) {
+                loop_contiguous(out, len, loaded, ixs);
+            }
+            else {
+                loop_strided(out, len, loaded, ixs);
+            }
+            return _as_typed_memoryview(bytes, buffer_format<R>::value);
+        }
+
+        std::unique_ptr<R[]> out(new R[len]);
+        if (all_contiguous) {
+            loop_contiguous(out.get(), len, loaded, ixs);
+        }
+        else {
+            loop_strided(out.get(), len, loaded, ixs);
+        }
+
+        PyObject *list = PyList_New(len);
+        if (!list) {
+            return nullptr;
+        }
+        for (Py_ssize_t ix = 0; ix < len; ++ix) {
+            PyObject *item = to_python(out[ix]);
+            if (!item) {
+                Py_DECREF(list);
+                return nullptr;
+            }
+            PyList_SET_ITEM(list, ix, item);
+        }
+        return list;
+    }
+
+    template<typename T>
+    static inline bool check_size(const _vectorized_arg<T> &arg,
+                                  Py_ssize_t &len,
+                                  bool &all_contiguous,
+                                  bool &any_buffer) {
+        if (arg.is_scalar()) {
+            all_contiguous = false;
+            return true;
+        }
+        any_buffer |= arg.is_buffer();
+        if (len >= 0 && arg.size != len) {
+            PyErr_Format(PyExc_ValueError,
+                         "arguments have mismatched lengths: %zd and %zd",
+                         len,
+                         arg.size);
+            return false;
+        }
+        len = arg.size;
+        return true;
+    }
+
+public:
+    static constexpr int flags = _meth_fastcall;
+
+    static inline PyObject *call(PyObject *const *args, Py_ssize_t nargs) {
+        if (nargs != static_cast<Py_ssize_t>(arity)) {
+            _bad_argument_count(arity, nargs);
+            return nullptr;
+        }
+        return call(args, std::make_index_sequence<arity>{});
+    }
+
+#if HAVE_FASTCALL
+    /**
+       The `METH_FASTCALL` entry point.
+    */
+    static PyObject *f(PyObject*, PyObject *const *args, Py_ssize_t nargs) {
+        return call(args, nargs);
+    }
+#else
+    /**
+       The `METH_VARARGS` entry point for versions of Python without
+       `METH_FASTCALL`.
+    */
+    static PyObject *f(PyObject*, PyObject *args) {
+        return call(reinterpret_cast<PyTupleObject*>(args)->ob_item,
+                    PyTuple_GET_SIZE(args));
+    }
+#endif // HAVE_FASTCALL
+};
+
+#define _libpy_automethod_vectorized_def(name, func, doc)  (PyMethodDef { \
+        name,                                                           \
+        (PyCFunction) (void (*)(void))                                  \
+        pyutils::_automethodwrapper_vectorized<decltype(func), func>::f, \
+        pyutils::_automethodwrapper_vectorized<decltype(func),          \
+                                               func>::flags,            \
+        doc,                                                            \
+    })
+
+#define _libpy_automethod_vectorized_2(func, doc)               \
+    _libpy_automethod_vectorized_def(#func, func, doc)
+#define _libpy_automethod_vectorized_1(func)            \
+    _libpy_automethod_vectorized_2(func, nullptr)
+
+    /**
+       Lift a scalar C++ function, like `double f(double, long)`, into a
+       python `PyMethodDef` structure which accepts either scalars or
+       sequences for each argument.
+
+       Sequences are converted once up front and the function is called
+       in a tight loop. Unlike `automethod`, the function does not take a
+       `self` argument.
+
+       @param func The function to wrap.
+       @param doc  The docstring to use for the function. If this is omitted
+                   the docstring will be `None`.
+       @return     A `PyMethodDef` structure for the given function.
+    */
+#define automethod_vectorized(...)                                      \
+    _libpy_automethod_dispatch(,##__VA_ARGS__,                          \
+                               _libpy_automethod_vectorized_2(__VA_ARGS__), \
+                               _libpy_automethod_vectorized_1(__VA_ARGS__))
+}
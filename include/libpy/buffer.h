@@ -0,0 +1,262 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <Python.h>
+
+#include "libpy/object.h"
+
+namespace pyutils {
+/**
+   The `struct` module format character for values of type `T` in a
+   buffer. The default case is left undefined to generate a compile-time
+   error for types which cannot be read from a buffer.
+*/
+template<typename T>
+struct buffer_format;
+
+#define _LIBPY_BUFFER_FORMAT(ctype, c)          \
+    template<>                                  \
+    struct buffer_format<ctype> {               \
+        static constexpr char value = c;        \
+    }
+
+_LIBPY_BUFFER_FORMAT(bool, '?');
+_LIBPY_BUFFER_FORMAT(signed char, 'b');
+_LIBPY_BUFFER_FORMAT(unsigned char, 'B');
+_LIBPY_BUFFER_FORMAT(short, 'h');
+_LIBPY_BUFFER_FORMAT(unsigned short, 'H');
+_LIBPY_BUFFER_FORMAT(int, 'i');
+_LIBPY_BUFFER_FORMAT(unsigned int, 'I');
+_LIBPY_BUFFER_FORMAT(long, 'l');
+_LIBPY_BUFFER_FORMAT(unsigned long, 'L');
+_LIBPY_BUFFER_FORMAT(long long, 'q');
+_LIBPY_BUFFER_FORMAT(unsigned long long, 'Q');
+_LIBPY_BUFFER_FORMAT(float, 'f');
+_LIBPY_BUFFER_FORMAT(double, 'd');
+
+#undef _LIBPY_BUFFER_FORMAT
+
+template<typename T>
+struct buffer_format<const T> : public buffer_format<T> {};
+
+/**
+   The kind of value described by a native `struct` format character:
+   'i' for signed integers, 'u' for unsigned integers, 'f' for floating
+   point, '?' for bool, or '\0' for anything else.
+*/
+inline char _buffer_format_kind(char c) {
+    switch (c) {
+    case 'b':
+    case 'h':
+    case 'i':
+    case 'l':
+    case 'q':
+    case 'n':
+        return 'i';
+    case 'B':
+    case 'H':
+    case 'I':
+    case 'L':
+    case 'Q':
+    case 'N':
+        return 'u';
+    case 'f':
+    case 'd':
+        return 'f';
+    case '?':
+        return '?';
+    default:
+        return '\0';
+    }
+}
+
+/**
+   Check if a buffer holds native values of type `T`.
+
+   Integer formats are compared by signedness and size, not by character,
+   because `long` and `long long` have the same layout on many platforms
+   and exporters are free to pick either.
+
+   @param format   The format of the buffer, nullptr means unsigned bytes.
+   @param itemsize The size of each item in the buffer.
+   @return         Does the buffer hold values of type `T`?
+*/
+template<typename T>
+inline bool buffer_format_matches(const char *format, Py_ssize_t itemsize) {
+    if (static_cast<std::size_t>(itemsize) != sizeof(T)) {
+        return false;
+    }
+    if (!format) {
+        format = "B";
+    }
+    if (*format == '@') {
+        ++format;
+    }
+    return format[0] && !format[1] &&
+        _buffer_format_kind(format[0]) ==
+        _buffer_format_kind(buffer_format<T>::value);
+}
+}
+
+namespace py {
+/**
+   A contiguous one dimensional view of the memory of an object which
+   implements the buffer protocol, for example a `bytes`, `array.array`,
+   or `memoryview`.
+
+   The buffer is acquired with `PyObject_GetBuffer` and released when the
+   view is destroyed. The format and contiguity are validated when the
+   buffer is acquired so the data may then be read without any checks.
+   If `T` is not const, the buffer must be writable.
+
+   The `Py_buffer` is kept in its own allocation so that moving the view
+   does not move it. Exporters may point into the `Py_buffer`, for
+   example `shape` is often `&view.len`, or key their release on its
+   address.
+
+   This may be used as an `automethod` parameter, for example:
+   `double sum(PyObject *self, py::buffer_view<const double> values)`.
+*/
+template<typename T>
+class buffer_view {
+private:
+    std::unique_ptr<Py_buffer> view;
+    T *ptr = nullptr;
+    py::ssize_t len = 0;
+
+    void release() {
+        if (view) {
+            PyBuffer_Release(view.get());
+            view.reset();
+        }
+        ptr = nullptr;
+        len = 0;
+    }
+
+public:
+    using value_type = T;
+
+    buffer_view() = default;
+
+    buffer_view(const buffer_view&) = delete;
+    buffer_view &operator=(const buffer_view&) = delete;
+
+    buffer_view(buffer_view &&mvfrom) noexcept
+        : view(std::move(mvfrom.view)),
+          ptr(mvfrom.ptr),
+          len(mvfrom.len) {
+        mvfrom.ptr = nullptr;
+        mvfrom.len = 0;
+    }
+
+    buffer_view &operator=(buffer_view &&mvfrom) noexcept {
+        release();
+        view = std::move(mvfrom.view);
+        ptr = mvfrom.ptr;
+        len = mvfrom.len;
+        mvfrom.ptr = nullptr;
+        mvfrom.len = 0;
+        return *this;
+    }
+
+    ~buffer_view() {
+        release();
+    }
+
+    /**
+       Acquire the buffer of an object, releasing any buffer already
+       held.
+
+       @param ob The object to view.
+       @return   true on success, false with a Python exception set on
+                 failure.
+    */
+    bool acquire(PyObject *ob) {
+        release();
+
+        int flags = PyBUF_FORMAT | PyBUF_C_CONTIGUOUS;
+        if (!std::is_const<T>::value) {
+            flags |= PyBUF_WRITABLE;
+        }
+        std::unique_ptr<Py_buffer> acquired(new (std::nothrow) Py_buffer);
+        if (!acquired) {
+            PyErr_NoMemory();
+            return false;
+        }
+        if (PyObject_GetBuffer(ob, acquired.get(), flags) < 0) {
+            return false;
+        }
+        view = std::move(acquired);
+
+        if (view->ndim > 1) {
+            PyErr_Format(PyExc_TypeError,
+                         "expected a 1 dimensional buffer, got %d dimensions",
+                         view->ndim);
+            release();
+            return false;
+        }
+        if (!pyutils::buffer_format_matches<T>(view->format, view->itemsize)) {
+            PyErr_Format(PyExc_TypeError,
+                         "expected a buffer of format '%c', got '%s'",
+                         pyutils::buffer_format<T>::value,
+                         view->format ? view->format : "B");
+            release();
+            return false;
+        }
+
+        ptr = static_cast<T*>(view->buf);
+        len = view->len / view->itemsize;
+        return true;
+    }
+
+    /**
+       Is a buffer currently held?
+    */
+    bool acquired() const {
+        return static_cast<bool>(view);
+    }
+
+    /**
+       The object which owns the memory.
+    */
+    PyObject *obj() const {
+        return view ? view->obj : nullptr;
+    }
+
+    T *data() const {
+        return ptr;
+    }
+
+    py::ssize_t size() const {
+        return len;
+    }
+
+    T &operator[](py::ssize_t ix) const {
+        return ptr[ix];
+    }
+
+    T *begin() const {
+        return ptr;
+    }
+
+    T *end() const {
+        return ptr + len;
+    }
+};
+}
+
+namespace pyutils {
+template<typename T>
+struct typeformat;
+
+template<typename T>
+struct typeformat<py::buffer_view<T>> {
+    static inline bool convert(PyObject *ob, py::buffer_view<T> &out) {
+        return out.acquire(ob);
+    }
+};
+}
@@ -0,0 +1,446 @@
+#pragma once
+#include <cstddef>
+#include <iterator>
+#include <tuple>
+#include <utility>
+
+#include "libpy/object.h"
+#include "libpy/to_python.h"
+#include "libpy/type.h"
+
+/**
+   Python 3.13 moved the known hash dict functions into the internal API.
+   On newer versions the hash is recomputed by the plain functions.
+*/
+#define HAVE_DICT_KNOWN_HASH (PY_VERSION_HEX < 0x030D0000)
+
+namespace py {
+namespace dict {
+/**
+   A subclass of `py::object` for optional dicts.
+*/
+class object : public py::object {
+private:
+    /**
+       Function called to verify that `ob` is a dict and
+       correctly raise a python exception otherwies.
+    */
+    void dict_check();
+public:
+    friend class py::tmpref<object>;
+
+    /**
+       Default constructor. This will set `ob` to nullptr.
+    */
+    object();
+
+    /**
+       Constructor from `PyObject*`. If `pob` is not a `dict` then
+       `ob` will be set to `nullptr`.
+    */
+    object(PyObject *pob);
+
+    /**
+       Constructor from `py::object`. If `pob` is not a `dict` then
+       `ob` will be set to `nullptr`.
+    */
+    object(const py::object &pob);
+
+    object(const object &cpfrom);
+    object(object &&mvfrom) noexcept;
+
+    using py::object::operator=;
+
+    /**
+       An iterator over the `(key, value)` pairs of a dict built on
+       `PyDict_Next`. The key and value are borrowed references.
+
+       If keys are added or removed while the dict is being iterated,
+       iteration stops with a `RuntimeError` set, like in Python, so
+       callers should check `PyErr_Occurred()` after the loop.
+    */
+    class const_iterator {
+    private:
+        PyObject *ob;
+        py::ssize_t pos;
+        py::ssize_t size;
+        std::pair<py::object, py::object> current;
+
+        void step() {
+            if (PyDict_Size(ob) != size) {
+                PyErr_SetString(PyExc_RuntimeError,
+                                "dictionary changed size during iteration");
+                ob = nullptr;
+                pos = 0;
+                return;
+            }
+            PyObject *key;
+            PyObject *value;
+            if (PyDict_Next(ob, &pos, &key, &value)) {
+                current.first = key;
+                current.second = value;
+            }
+            else {
+                ob = nullptr;
+                pos = 0;
+            }
+        }
+
+    public:
+        using value_type = std::pair<py::object, py::object>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+        using iterator_category = std::forward_iterator_tag;
+
+        /**
+           Construct an iterator at the start of `ob`, or the end iterator
+           if `ob` is nullptr.
+        */
+        explicit const_iterator(PyObject *ob = nullptr)
+            : ob(ob),
+              pos(0),
+              size(ob ? PyDict_Size(ob) : 0) {
+            if (ob) {
+                step();
+            }
+        }
+
+        reference operator*() const {
+            return current;
+        }
+
+        pointer operator->() const {
+            return &current;
+        }
+
+        const_iterator &operator++() {
+            step();
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator out = *this;
+            step();
+            return out;
+        }
+
+        bool operator==(const const_iterator &other) const {
+            return ob == other.ob && pos == other.pos;
+        }
+
+        bool operator!=(const const_iterator &other) const {
+            return !(*this == other);
+        }
+    };
+    typedef const_iterator iterator;
+
+    const_iterator cbegin() const;
+    const_iterator cend() const;
+    iterator begin() const;
+    iterator end() const;
+
+    /**
+       Get the number of items in the dict.
+
+       This is equivalent to `len(this)`.
+
+       @return The length of the object or -1 if an exception occured.
+    */
+    py::ssize_t len() const;
+
+    using py::object::operator[];
+
+    /**
+       Look up `key` without raising a `KeyError`.
+
+       This is equivalent to `this.get(key)` except that a missing key
+       does not set an exception.
+
+       @param key The key to look up.
+       @return    A borrowed reference to the value, or nullptr. When
+                  nullptr is returned a Python exception is set only if
+                  the key could not be hashed or compared.
+    */
+    py::object get(const py::object &key) const;
+
+    /**
+       Look up `key` with a precomputed hash. The hash of one key may be
+       reused to probe several dicts.
+
+       @param key  The key to look up.
+       @param hash The hash of `key`, as returned by `key.hash()`.
+       @return     A borrowed reference to the value, or nullptr. When
+                   nullptr is returned a Python exception is set only if
+                   the key could not be compared.
+    */
+    py::object get(const py::object &key, py::hash_t hash) const;
+
+    /**
+       Check if the dict has a key.
+
+       This is equivalent to: `key in this`.
+
+       @param key The key to check.
+       @return    1 if the key is present, 0 if it is not, -1 if an
+                  exception occured.
+    */
+    int contains(const py::object &key) const;
+
+    /**
+       Check if the dict has a key with a precomputed hash.
+
+       @see get(const py::object&, py::hash_t)
+    */
+    int contains(const py::object &key, py::hash_t hash) const;
+
+    /**
+       Set `this[key] = value`. This does not steal a reference to either
+       argument.
+
+       @param key   The key to set.
+       @param value The value to store.
+       @return      zero on success, non-zero on failure.
+    */
+    int setitem(const py::object &key, const py::object &value) const;
+
+    /**
+       Set `this[key] = value` with a precomputed hash.
+
+       @see setitem(const py::object&, const py::object&)
+    */
+    int setitem(const py::object &key,
+                py::hash_t hash,
+                const py::object &value) const;
+
+    /**
+       Remove `key` from the dict.
+
+       This is equivalent to: `del this[key]`.
+
+       @param key The key to remove.
+       @return    zero on success, non-zero on failure. A missing key
+                  raises a `KeyError`.
+    */
+    int delitem(const py::object &key) const;
+
+    /**
+       Coerce to a `nonnull` object.
+
+       @see nonnull
+       @throws pyutil::bad_nonnull Thrown when `ob == nullptr`.
+       @return this converted to a `nonnull` object.
+    */
+    nonnull<object> as_nonnull() const;
+
+    /**
+       Create a temporary reference. This is a reference that will
+       decref the object when it is destroyed.
+
+       @return this converted into a tmpref.
+    */
+    tmpref<object> as_tmpref() &&;
+};
+
+/**
+   The type of Python `dict` objects.
+
+   This is equivalent to: `dict`.
+*/
+extern const type::object<dict::object> type;
+
+/**
+   Check if an object is an instance of `dict`.
+
+   @param t The object to check
+   @return  1 if `ob` is an instance of `dict`, 0 if `ob` is not an
+            instance of `dict`, -1 if an exception occured.
+*/
+template<typename T>
+inline int check(const T &t) {
+    if (!t.is_nonnull()) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    return PyDict_Check(t);
+}
+
+inline int check(const nonnull<object>&) {
+    return 1;
+}
+
+/**
+   Check if an object is an instance of `dict` but not a subclass.
+
+   @param t The object to check
+   @return  1 if `ob` is an instance of `dict`, 0 if `ob` is not an
+            instance of `dict`, -1 if an exception occured.
+*/
+template<typename T>
+inline int checkexact(const T &t) {
+    if (!t.is_nonnull()) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    return PyDict_CheckExact(t);
+}
+
+inline int checkexact(const nonnull<object>&) {
+    return 1;
+}
+}
+
+/**
+   A `py::dict::object` where `ob` is known to be nonnull.
+   This is used to skip null checks for performance.
+
+   This class should be used where users want to trade the ability to
+   write a nested expression for perfomance.
+*/
+template<>
+class nonnull<dict::object> : public dict::object {
+protected:
+    nonnull() = delete;
+    explicit nonnull(PyObject *ob) : dict::object(ob) {}
+public:
+    friend class object;
+
+    nonnull(const nonnull &cpfrom) : dict::object(cpfrom) {}
+    nonnull(nonnull &&mvfrom) noexcept : dict::object(mvfrom.ob) {
+        mvfrom.ob = nullptr;
+    }
+
+    nonnull &operator=(const nonnull &cpfrom) {
+        nonnull<dict::object> tmp(cpfrom);
+        return (*this = std::move(tmp));
+    }
+
+    nonnull &operator=(nonnull &&mvfrom) noexcept {
+        ob = mvfrom.ob;
+        mvfrom.ob = nullptr;
+        return *this;
+    }
+
+    /**
+       Get the number of items in the dict.
+
+       This is equivalent to `len(this)`.
+
+       @return The length of the object.
+    */
+    py::ssize_t len() const {
+        return reinterpret_cast<PyDictObject*>(ob)->ma_used;
+    }
+};
+
+namespace dict {
+/**
+   Create an empty dict with room for `n` items before it needs to
+   resize.
+
+   @param n The expected number of items.
+   @return  The new dict, or nullptr with a Python exception set.
+*/
+tmpref<object> presized(py::ssize_t n);
+
+/**
+   Allocate the dict for `from_range`, presized when `[first, last)` may
+   be measured without consuming it.
+*/
+template<typename It>
+tmpref<object> _new_for_range(It first, It last, std::true_type) {
+    return presized(std::distance(first, last));
+}
+
+template<typename It>
+tmpref<object> _new_for_range(It, It, std::false_type) {
+    return PyDict_New();
+}
+
+/**
+   Build a `dict` from the `(key, value)` pairs in `[first, last)`, for
+   example the entries of a `std::map` or `std::unordered_map`.
+
+   For forward iterators the dict is presized for the number of pairs.
+   Each key and value is converted with `to_python`. Later pairs replace
+   earlier pairs with an equal key.
+
+   @param first The start of the pairs. Input iterators are consumed
+                once while inserting.
+   @param last  The end of the pairs.
+   @return      The new dict, or nullptr with a Python exception set.
+*/
+template<typename It>
+tmpref<object> from_range(It first, It last) {
+    using forward = pyutils::_is_forward_iterator<It>;
+    tmpref<object> out = _new_for_range(first, last, forward{});
+    if (!out.is_nonnull()) {
+        return nullptr;
+    }
+
+    pyutils::_pending_error pending;
+    for (; first != last; ++first) {
+        // input iterators may produce their pairs by value
+        auto &&pair = *first;
+        tmpref<py::object> key(pyutils::to_python(pair.first));
+        if (!key.is_nonnull()) {
+            pyutils::failed_null_check();
+            return nullptr;
+        }
+        tmpref<py::object> value(pyutils::to_python(pair.second));
+        if (!value.is_nonnull()) {
+            pyutils::failed_null_check();
+            return nullptr;
+        }
+        if (PyDict_SetItem(out, key, value)) {
+            return nullptr;
+        }
+    }
+    // Python iterators stop at the first error instead of reporting it
+    if (!forward::value && PyErr_Occurred()) {
+        return nullptr;
+    }
+    return out;
+}
+
+/**
+   Build a `dict` from a C++ map or other range of pairs.
+
+   @see from_range(It, It)
+*/
+template<typename M>
+tmpref<object> from_map(const M &map) {
+    return from_range(map.begin(), map.end());
+}
+}
+}
+
+namespace pyutils {
+template<typename T>
+struct typeformat;
+
+template<>
+struct typeformat<py::dict::object> {
+    static char_sequence<'O', '!'> cs;
+
+    template<typename T>
+    static inline auto make_arg(T &&t) {
+        return std::make_tuple(&PyDict_Type, std::forward<T>(t));
+    }
+
+    static inline PyTypeObject *exact_type() {
+        return &PyDict_Type;
+    }
+
+    static inline bool convert(PyObject *ob, py::dict::object &out) {
+        if (!PyDict_Check(ob)) {
+            PyErr_Format(PyExc_TypeError,
+                         "must be dict, not %.50s",
+                         Py_TYPE(ob)->tp_name);
+            return false;
+        }
+        out = py::object(ob);
+        return true;
+    }
+};
+}
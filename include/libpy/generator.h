@@ -0,0 +1,119 @@
+#pragma once
+#include <exception>
+#include <type_traits>
+#include <utility>
+
+#include <Python.h>
+
+#include "libpy/object.h"
+#include "libpy/to_python.h"
+#include "libpy/type_builder.h"
+#include "libpy/utils.h"
+
+namespace py {
+/**
+   The value stored in each generator object: the C++ functor and whether
+   it has finished.
+*/
+template<typename F>
+struct _generator_state {
+    F f;
+    bool done;
+
+    explicit _generator_state(F &&f) : f(std::move(f)), done(false) {}
+};
+
+/**
+   The Python type for generators which call `F`. One type is created
+   for each functor type and is never released.
+*/
+template<typename F>
+struct _generator_type {
+private:
+    using state = _generator_state<F>;
+    using value_type = typename pyutils::_unary_argument<F>::type;
+
+    static PyObject *iter(PyObject *self) {
+        Py_INCREF(self);
+        return self;
+    }
+
+    static PyObject *iternext(PyObject *self) {
+        state &s = type::unbox<state>(self);
+        if (s.done) {
+            return nullptr;
+        }
+
+        value_type out{};
+        bool more = false;
+        try {
+            more = s.f(out);
+        }
+        catch (const std::exception &e) {
+            PyErr_SetString(PyExc_RuntimeError, e.what());
+        }
+        catch (...) {
+            PyErr_SetString(PyExc_RuntimeError, "unknown error in generator");
+        }
+        if (!more) {
+            // a Python exception set by `f` is propagated, otherwise this
+            // is `StopIteration`
+            s.done = true;
+            return nullptr;
+        }
+        return pyutils::to_python(std::move(out));
+    }
+
+public:
+    /**
+       @return A borrowed reference to the type, or nullptr with a Python
+               exception set.
+    */
+    static PyTypeObject *get() {
+        static PyObject *cls = nullptr;
+        if (!cls) {
+            tmpref<type::object<>> created =
+                type::builder<state>("libpy.generator")
+                .slot(Py_tp_iter, reinterpret_cast<void*>(iter))
+                .slot(Py_tp_iternext, reinterpret_cast<void*>(iternext))
+                .create();
+            cls = created;
+            std::move(created).invalidate();
+        }
+        return reinterpret_cast<PyTypeObject*>(cls);
+    }
+};
+
+/**
+   Wrap a C++ functor as a Python iterator.
+
+   The functor is called with a reference to a default constructed value
+   and returns true after filling it in, or false when there are no more
+   values, for example: `bool operator()(long &out)`. Each value is
+   converted with `to_python` as it is produced, so results may be
+   streamed without building a list. The iterator's `tp_iternext` calls
+   the functor directly without a Python frame.
+
+   To raise an exception the functor may set a Python exception and
+   return false, or throw, which is raised as a `RuntimeError`. The
+   iterator is exhausted after the functor returns false.
+
+   The functor is stored inline in the iterator object and is destroyed
+   with it. Generator objects do not support the cyclic garbage
+   collector, so the functor should not own references which may refer
+   back to the generator.
+
+   @param f The functor.
+   @return  A new reference to the iterator, or nullptr with a Python
+            exception set.
+*/
+template<typename F>
+tmpref<object> generator(F &&f) {
+    using G = std::decay_t<F>;
+    PyTypeObject *cls = _generator_type<G>::get();
+    if (!cls) {
+        return nullptr;
+    }
+    return type::emplace<_generator_state<G>>(cls, G(std::forward<F>(f)));
+}
+}
@@ -0,0 +1,604 @@
+#pragma once
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <Python.h>
+
+#include "libpy/list.h"
+#include "libpy/object.h"
+#include "libpy/to_python.h"
+
+namespace py {
+namespace iter {
+/**
+   A block of items taken from an iterator by `chunked`. The items are
+   owned by the `chunked` range and are released when the next block is
+   taken.
+*/
+class chunk {
+private:
+    PyObject *const *items;
+    ssize_t len;
+
+public:
+    typedef const py::object* const_iterator;
+    typedef const_iterator iterator;
+
+    chunk(PyObject *const *items, ssize_t len) : items(items), len(len) {}
+
+    const_iterator begin() const {
+        return reinterpret_cast<const py::object*>(items);
+    }
+
+    const_iterator end() const {
+        return begin() + len;
+    }
+
+    ssize_t size() const {
+        return len;
+    }
+
+    const py::object &operator[](ssize_t ix) const {
+        return begin()[ix];
+    }
+};
+
+/**
+   Iterate over any iterable in blocks of up to `n` items.
+
+   Each block is filled with `py::object::next_batch` so the loop which
+   consumes the items does not call back into the iterator. For example:
+
+   ```
+   for (const auto &block : py::iter::chunked(rows, 1024)) {
+       for (const py::object &row : block) {
+           ...
+       }
+   }
+   ```
+
+   Iteration stops at the end of the iterable or at the first error, so
+   callers should check `PyErr_Occurred()` after the loop. On error the
+   items from the failed block are not seen.
+*/
+class chunked {
+private:
+    tmpref<object> it;
+    std::unique_ptr<PyObject*[]> items;
+    ssize_t capacity;
+    ssize_t len;
+
+    void release() {
+        for (ssize_t ix = 0; ix < len; ++ix) {
+            Py_DECREF(items[ix]);
+        }
+        len = 0;
+    }
+
+    /**
+       Take the next block, returns false once there are no more items.
+    */
+    bool fill() {
+        release();
+        if (!it.is_nonnull()) {
+            return false;
+        }
+        ssize_t taken = it.next_batch(items.get(), capacity);
+        if (taken <= 0) {
+            it.decref();
+            std::move(it).invalidate();
+            return false;
+        }
+        len = taken;
+        return true;
+    }
+
+public:
+    class iterator
+        : public std::iterator<std::input_iterator_tag, chunk, void> {
+    private:
+        chunked *range;
+
+    public:
+        explicit iterator(chunked *range = nullptr) : range(range) {
+            if (range && !range->fill()) {
+                this->range = nullptr;
+            }
+        }
+
+        bool operator==(const iterator &other) const {
+            return range == other.range;
+        }
+
+        bool operator!=(const iterator &other) const {
+            return !(*this == other);
+        }
+
+        chunk operator*() const {
+            return {range->items.get(), range->len};
+        }
+
+        iterator &operator++() {
+            if (range && !range->fill()) {
+                range = nullptr;
+            }
+            return *this;
+        }
+    };
+
+    typedef iterator const_iterator;
+
+    /**
+       @param iterable The object to iterate over.
+       @param n        The maximum number of items in each block.
+    */
+    chunked(const py::object &iterable, ssize_t n)
+        : it(nullptr), capacity(n), len(0) {
+        if (n <= 0) {
+            PyErr_SetString(PyExc_ValueError, "chunk size must be positive");
+            return;
+        }
+        it = iterable.iter();
+        if (it.is_nonnull()) {
+            items.reset(new PyObject*[n]);
+        }
+    }
+
+    chunked(const chunked&) = delete;
+    chunked &operator=(const chunked&) = delete;
+
+    ~chunked() {
+        release();
+    }
+
+    /**
+       Take the first block. This may only be called once.
+    */
+    iterator begin() {
+        return iterator(this);
+    }
+
+    iterator end() {
+        return iterator();
+    }
+};
+
+/**
+   The iterator type of a range.
+*/
+template<typename R>
+using _range_iterator = decltype(std::declval<R&>().begin());
+
+/**
+   The type produced by dereferencing an iterator of a range. For Python
+   containers this is a borrowed `const py::object&`.
+*/
+template<typename R>
+using _range_reference = decltype(*std::declval<_range_iterator<R>&>());
+
+/**
+   The lazy adaptors store their input range by reference when it is an
+   lvalue and by value when it is an rvalue, so adaptors may be nested
+   without dangling: `map(filter(xs, pred), f)`.
+
+   Like `py::object`'s iterator, the adaptors are single pass. The items
+   of Python containers are borrowed, so they are only valid until the
+   iterator advances.
+*/
+template<typename R, typename F>
+class map_range {
+private:
+    R range;
+    F f;
+
+public:
+    class iterator
+        : public std::iterator<
+        std::input_iterator_tag,
+        std::decay_t<decltype(std::declval<const F&>()(
+                                  std::declval<_range_reference<R>>()))>,
+        void> {
+    private:
+        _range_iterator<R> it;
+        const F *f;
+
+    public:
+        iterator(_range_iterator<R> it, const F *f)
+            : it(std::move(it)), f(f) {}
+
+        bool operator==(const iterator &other) const {
+            return it == other.it;
+        }
+
+        bool operator!=(const iterator &other) const {
+            return !(*this == other);
+        }
+
+        decltype(auto) operator*() const {
+            return (*f)(*it);
+        }
+
+        iterator &operator++() {
+            ++it;
+            return *this;
+        }
+    };
+
+    map_range(R &&range, F f)
+        : range(std::forward<R>(range)), f(std::move(f)) {}
+
+    iterator begin() {
+        return {range.begin(), &f};
+    }
+
+    iterator end() {
+        return {range.end(), &f};
+    }
+};
+
+/**
+   Lazily apply `f` to each item of `range`.
+
+   @param range The range to map over, for example a `py::object`.
+   @param f     The function to apply. This is called each time the
+                iterator is dereferenced.
+   @return      The mapped range.
+*/
+template<typename R, typename F>
+map_range<R, std::decay_t<F>> map(R &&range, F &&f) {
+    return {std::forward<R>(range), std::forward<F>(f)};
+}
+
+template<typename R, typename F>
+class filter_range {
+private:
+    R range;
+    F pred;
+
+public:
+    class iterator
+        : public std::iterator<std::input_iterator_tag,
+                               std::decay_t<_range_reference<R>>,
+                               void> {
+    private:
+        _range_iterator<R> it;
+        _range_iterator<R> last;
+        const F *pred;
+
+        void skip() {
+            while (it != last && !(*pred)(*it)) {
+                ++it;
+            }
+        }
+
+    public:
+        iterator(_range_iterator<R> it,
+                 _range_iterator<R> last,
+                 const F *pred)
+            : it(std::move(it)), last(std::move(last)), pred(pred) {
+            skip();
+        }
+
+        bool operator==(const iterator &other) const {
+            return it == other.it;
+        }
+
+        bool operator!=(const iterator &other) const {
+            return !(*this == other);
+        }
+
+        decltype(auto) operator*() const {
+            return *it;
+        }
+
+        iterator &operator++() {
+            ++it;
+            skip();
+            return *this;
+        }
+    };
+
+    filter_range(R &&range, F pred)
+        : range(std::forward<R>(range)), pred(std::move(pred)) {}
+
+    iterator begin() {
+        return {range.begin(), range.end(), &pred};
+    }
+
+    iterator end() {
+        return {range.end(), range.end(), &pred};
+    }
+};
+
+/**
+   Lazily select the items of `range` for which `pred` is true.
+
+   @param range The range to filter.
+   @param pred  The predicate, this is called once per item.
+   @return      The filtered range.
+*/
+template<typename R, typename F>
+filter_range<R, std::decay_t<F>> filter(R &&range, F &&pred) {
+    return {std::forward<R>(range), std::forward<F>(pred)};
+}
+
+template<typename R>
+class enumerate_range {
+private:
+    R range;
+    ssize_t start;
+
+public:
+    class iterator
+        : public std::iterator<
+        std::input_iterator_tag,
+        std::pair<ssize_t, std::decay_t<_range_reference<R>>>,
+        void> {
+    private:
+        _range_iterator<R> it;
+        ssize_t ix;
+
+    public:
+        iterator(_range_iterator<R> it, ssize_t ix)
+            : it(std::move(it)), ix(ix) {}
+
+        bool operator==(const iterator &other) const {
+            return it == other.it;
+        }
+
+        bool operator!=(const iterator &other) const {
+            return !(*this == other);
+        }
+
+        std::pair<ssize_t, _range_reference<R>> operator*() const {
+            return {ix, *it};
+        }
+
+        iterator &operator++() {
+            ++it;
+            ++ix;
+            return *this;
+        }
+    };
+
+    enumerate_range(R &&range, ssize_t start)
+        : range(std::forward<R>(range)), start(start) {}
+
+    iterator begin() {
+        return {range.begin(), start};
+    }
+
+    iterator end() {
+        return {range.end(), start};
+    }
+};
+
+/**
+   Lazily pair each item of `range` with its index.
+
+   @param range The range to enumerate.
+   @param start The first index.
+   @return      A range of `std::pair`s of the index and the item.
+*/
+template<typename R>
+enumerate_range<R> enumerate(R &&range, ssize_t start = 0) {
+    return {std::forward<R>(range), start};
+}
+
+template<typename R>
+class take_range {
+private:
+    R range;
+    ssize_t n;
+
+public:
+    class iterator
+        : public std::iterator<std::input_iterator_tag,
+                               std::decay_t<_range_reference<R>>,
+                               void> {
+    private:
+        _range_iterator<R> it;
+        _range_iterator<R> last;
+        ssize_t remaining;
+
+        bool done() const {
+            return remaining <= 0 || it == last;
+        }
+
+    public:
+        iterator(_range_iterator<R> it,
+                 _range_iterator<R> last,
+                 ssize_t remaining)
+            : it(std::move(it)), last(std::move(last)), remaining(remaining) {}
+
+        bool operator==(const iterator &other) const {
+            if (done() || other.done()) {
+                return done() && other.done();
+            }
+            return it == other.it;
+        }
+
+        bool operator!=(const iterator &other) const {
+            return !(*this == other);
+        }
+
+        decltype(auto) operator*() const {
+            return *it;
+        }
+
+        iterator &operator++() {
+            // do not pull an item we will not use out of the underlying
+            // iterator
+            if (--remaining > 0) {
+                ++it;
+            }
+            return *this;
+        }
+    };
+
+    take_range(R &&range, ssize_t n) : range(std::forward<R>(range)), n(n) {}
+
+    iterator begin() {
+        if (n <= 0) {
+            // `range.begin()` may already pull the first item
+            return end();
+        }
+        return {range.begin(), range.end(), n};
+    }
+
+    iterator end() {
+        return {range.end(), range.end(), 0};
+    }
+};
+
+/**
+   Lazily take at most the first `n` items of `range`. Items after the
+   first `n` are never requested from the underlying iterator.
+
+   @param range The range to take from.
+   @param n     The maximum number of items.
+   @return      The truncated range.
+*/
+template<typename R>
+take_range<R> take(R &&range, ssize_t n) {
+    return {std::forward<R>(range), n};
+}
+
+template<typename... Rs>
+class zip_range {
+private:
+    std::tuple<Rs...> ranges;
+
+    using iterators = std::tuple<_range_iterator<Rs>...>;
+
+    template<std::size_t... ns>
+    iterators begins(std::index_sequence<ns...>) {
+        return iterators(std::get<ns>(ranges).begin()...);
+    }
+
+    template<std::size_t... ns>
+    iterators ends(std::index_sequence<ns...>) {
+        return iterators(std::get<ns>(ranges).end()...);
+    }
+
+public:
+    class iterator
+        : public std::iterator<
+        std::input_iterator_tag,
+        std::tuple<std::decay_t<_range_reference<Rs>>...>,
+        void> {
+    private:
+        iterators its;
+        iterators lasts;
+
+        template<std::size_t... ns>
+        bool done(std::index_sequence<ns...>) const {
+            bool out = false;
+            (void) std::initializer_list<bool>{
+                (out = out || std::get<ns>(its) == std::get<ns>(lasts))...};
+            return out;
+        }
+
+        bool done() const {
+            return done(std::index_sequence_for<Rs...>{});
+        }
+
+        template<std::size_t... ns>
+        std::tuple<_range_reference<Rs>...>
+        deref(std::index_sequence<ns...>) const {
+            return std::tuple<_range_reference<Rs>...>(*std::get<ns>(its)...);
+        }
+
+        template<std::size_t... ns>
+        void advance(std::index_sequence<ns...>) {
+            (void) std::initializer_list<int>{(++std::get<ns>(its), 0)...};
+        }
+
+    public:
+        iterator(iterators its, iterators lasts)
+            : its(std::move(its)), lasts(std::move(lasts)) {}
+
+        bool operator==(const iterator &other) const {
+            if (done() || other.done()) {
+                return done() && other.done();
+            }
+            return its == other.its;
+        }
+
+        bool operator!=(const iterator &other) const {
+            return !(*this == other);
+        }
+
+        std::tuple<_range_reference<Rs>...> operator*() const {
+            return deref(std::index_sequence_for<Rs...>{});
+        }
+
+        iterator &operator++() {
+            advance(std::index_sequence_for<Rs...>{});
+            return *this;
+        }
+    };
+
+    zip_range(Rs&&... ranges) : ranges(std::forward<Rs>(ranges)...) {}
+
+    iterator begin() {
+        return {begins(std::index_sequence_for<Rs...>{}),
+                ends(std::index_sequence_for<Rs...>{})};
+    }
+
+    iterator end() {
+        auto lasts = ends(std::index_sequence_for<Rs...>{});
+        return {lasts, lasts};
+    }
+};
+
+/**
+   Lazily step through several ranges together, stopping at the end of
+   the shortest.
+
+   @param ranges The ranges to zip.
+   @return       A range of `std::tuple`s of the items.
+*/
+template<typename... Rs>
+zip_range<Rs...> zip(Rs&&... ranges) {
+    return {std::forward<Rs>(ranges)...};
+}
+
+/**
+   Evaluate a range, converting each item with `to_python`, into a new
+   `list`. This is where Python objects are created for the outputs of a
+   chain of adaptors.
+
+   @param range The range to collect.
+   @return      The new list, or nullptr with a Python exception set. A
+                Python exception raised while iterating is propagated.
+*/
+template<typename R>
+tmpref<list::object> collect(R &&range) {
+    tmpref<py::object> out(PyList_New(0));
+    if (!out.is_nonnull()) {
+        return nullptr;
+    }
+    // an exception raised while iterating is only visible through
+    // `PyErr_Occurred()`, so set aside one which is already pending
+    pyutils::_pending_error pending;
+    for (auto &&item : range) {
+        tmpref<py::object> converted(
+            pyutils::to_python(std::forward<decltype(item)>(item)));
+        if (!converted.is_nonnull() || PyList_Append(out, converted)) {
+            return nullptr;
+        }
+    }
+    if (PyErr_Occurred()) {
+        return nullptr;
+    }
+    PyObject *result = out;
+    std::move(out).invalidate();
+    return result;
+}
+}
+}
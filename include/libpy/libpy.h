@@ -1,8 +1,21 @@
 #pragma once
 
 #include "libpy/object.h"
+#include "libpy/attrcache.h"
+#include "libpy/automethod_stats.h"
+#include "libpy/automethod_vectorized.h"
+#include "libpy/buffer.h"
+#include "libpy/dict.h"
+#include "libpy/generator.h"
+#include "libpy/iter.h"
 #include "libpy/tuple.h"
 #include "libpy/type.h"
+#include "libpy/type_builder.h"
 #include "libpy/list.h"
 #include "libpy/long.h"
+#include "libpy/parallel.h"
+#include "libpy/prepared_call.h"
+#include "libpy/set.h"
+#include "libpy/str.h"
+#include "libpy/to_python.h"
 #include "libpy/utils.h"
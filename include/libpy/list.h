@@ -1,7 +1,10 @@
 #pragma once
+#include <iterator>
 #include <tuple>
+#include <vector>
 
 #include "libpy/object.h"
+#include "libpy/to_python.h"
 #include "libpy/type.h"
 
 namespace py {
@@ -24,6 +27,40 @@ protected:
     return reinterpret_cast<py::object*>(
         reinterpret_cast<PyListObject* const>(ob)->ob_item);
 }
+
+    /**
+       Append `item` to a nonnull list which has spare capacity. This
+       steals a reference to `item`.
+    */
+    inline void append_reserved(PyObject *item) const {
+        py::ssize_t size = Py_SIZE(ob);
+        reinterpret_cast<PyListObject*>(ob)->ob_item[size] = item;
+        Py_SET_SIZE(ob, size + 1);
+    }
+
+    /**
+       Append the values of a list or tuple, this may be the list itself.
+    */
+    int extend_sequence(PyObject *other) const;
+
+    /**
+       Append the values of any other iterable.
+    */
+    int extend_iterable(PyObject *iterable) const;
+
+    /**
+       Reserve room for `[first, last)` when it may be measured without
+       consuming it.
+    */
+    template<typename It>
+    int reserve_for(It first, It last, std::true_type) const {
+        return reserve(Py_SIZE(ob) + std::distance(first, last));
+    }
+
+    template<typename It>
+    int reserve_for(It, It, std::false_type) const {
+        return 0;
+    }
 public:
     friend class py::tmpref<object>;
 
@@ -168,6 +205,9 @@ public:
     /**
        Append an element to a list.
 
+       When the list has spare capacity, for example after `reserve`, the
+       element is written directly into the list's storage.
+
        @param elem The element to append.
        @return -1 on failure, otherwise zero.
     */
@@ -177,7 +217,111 @@ public:
             pyutils::failed_null_check();
             return -1;
         }
-        return PyList_Append(*this, elem);
+        PyObject *item = elem;
+        if (reinterpret_cast<PyListObject*>(ob)->allocated > Py_SIZE(ob)) {
+            Py_INCREF(item);
+            append_reserved(item);
+            return 0;
+        }
+        return PyList_Append(ob, item);
+    }
+
+    /**
+       Get the number of elements the list can hold before it needs to
+       grow its storage.
+
+       @return The capacity of the list or -1 if an exception occured.
+    */
+    py::ssize_t capacity() const;
+
+    /**
+       Grow the list's storage to hold at least `n` elements. This does
+       not change the length of the list.
+
+       `append` and `extend` fill the reserved storage without
+       reallocating. Note that `PyList_Append` and the Python level list
+       methods may shrink storage which is less than half full.
+
+       @param n The number of elements to make room for.
+       @return  -1 on failure, otherwise zero.
+    */
+    int reserve(py::ssize_t n) const;
+
+    /**
+       Release any storage beyond the length of the list.
+
+       @return -1 on failure, otherwise zero.
+    */
+    int shrink_to_fit() const;
+
+    /**
+       Append the elements of another object.
+
+       The elements of a list or tuple are copied in one pass after
+       growing the list once. Other iterables, for example buffers, are
+       iterated after reserving room for their `__length_hint__`.
+
+       @param other The iterable to append.
+       @return      -1 on failure, otherwise zero. Elements appended
+                    before a failure are kept.
+    */
+    int extend(const py::object &other) const;
+
+    /**
+       Append the values in `[first, last)`, each converted with
+       `to_python`.
+
+       @param first The start of the values. The list is only grown up
+                    front for forward iterators, input iterators like a
+                    generator's are consumed once while appending.
+       @param last  The end of the values.
+       @return      -1 on failure, otherwise zero. Elements appended
+                    before a failure are kept.
+    */
+    template<typename It>
+    int extend(It first, It last) const {
+        if (!is_nonnull()) {
+            pyutils::failed_null_check();
+            return -1;
+        }
+        if (reserve_for(first, last, pyutils::_is_forward_iterator<It>{})) {
+            return -1;
+        }
+        pyutils::_pending_error pending;
+        for (; first != last; ++first) {
+            PyObject *item = pyutils::to_python(*first);
+            if (!item) {
+                pyutils::failed_null_check();
+                return -1;
+            }
+            if (reinterpret_cast<PyListObject*>(ob)->allocated > Py_SIZE(ob)) {
+                append_reserved(item);
+                continue;
+            }
+            int err = PyList_Append(ob, item);
+            Py_DECREF(item);
+            if (err) {
+                return -1;
+            }
+        }
+        // Python iterators stop at the first error instead of reporting it
+        return PyErr_Occurred() ? -1 : 0;
+    }
+
+    /**
+       Append the values of a C++ range, for example a `std::vector` or a
+       `py::buffer_view`, each converted with `to_python`.
+
+       @see extend(It, It)
+    */
+    template<typename R,
+             typename = std::enable_if_t<
+                 !std::is_base_of<py::object, std::decay_t<R>>::value &&
+                 !std::is_pointer<std::decay_t<R>>::value>>
+    int extend(const R &range) const {
+        using std::begin;
+        using std::end;
+        return extend(begin(range), end(range));
     }
 
     /**
@@ -334,6 +478,120 @@ tmpref<object> pack(const Ts&... elems) {
     }
     return std::move(l);
 }
+
+/**
+   Convert a value for `from_range`. A conversion which fails without
+   setting an exception, such as a `py::object` wrapping nullptr, raises
+   an `AssertionError`.
+*/
+template<typename It>
+inline PyObject *_from_range_item(It &it) {
+    PyObject *item = pyutils::to_python(*it);
+    if (!item) {
+        pyutils::failed_null_check();
+    }
+    return item;
+}
+
+/**
+   `from_range` for forward iterators, the list is allocated at its final
+   size.
+*/
+template<typename It>
+tmpref<object> _from_range(It first, It last, std::true_type) {
+    py::ssize_t len = std::distance(first, last);
+    tmpref<py::object> out(PyList_New(len));
+    if (!out.is_nonnull()) {
+        return nullptr;
+    }
+
+    PyObject **items = reinterpret_cast<PyListObject*>(
+        static_cast<PyObject*>(out))->ob_item;
+    for (py::ssize_t ix = 0; ix < len; ++ix, ++first) {
+        // unfilled slots are nullptr which the list's dealloc skips
+        if (!(items[ix] = _from_range_item(first))) {
+            return nullptr;
+        }
+    }
+
+    PyObject *result = out;
+    std::move(out).invalidate();
+    return result;
+}
+
+/**
+   `from_range` for input iterators, which can only be traversed once so
+   their length is not known up front.
+*/
+template<typename It>
+tmpref<object> _from_range(It first, It last, std::false_type) {
+    tmpref<py::object> out(PyList_New(0));
+    if (!out.is_nonnull()) {
+        return nullptr;
+    }
+
+    pyutils::_pending_error pending;
+    for (; first != last; ++first) {
+        PyObject *item = _from_range_item(first);
+        if (!item) {
+            return nullptr;
+        }
+        int err = PyList_Append(out, item);
+        Py_DECREF(item);
+        if (err) {
+            return nullptr;
+        }
+    }
+    // Python iterators stop at the first error instead of reporting it
+    if (PyErr_Occurred()) {
+        return nullptr;
+    }
+
+    PyObject *result = out;
+    std::move(out).invalidate();
+    return result;
+}
+
+/**
+   Build a `list` from the values in `[first, last)`.
+
+   For forward iterators the list is allocated at its final size and
+   each value is converted with `to_python` directly into the list's
+   storage. Input iterators, like the iterator of a Python generator, are
+   appended to a growing list. If a conversion fails, or an exception is
+   thrown, the partially filled list is released.
+
+   @param first The start of the values.
+   @param last  The end of the values.
+   @return      The new list, or nullptr with a Python exception set.
+*/
+template<typename It>
+tmpref<object> from_range(It first, It last) {
+    return _from_range(first, last, pyutils::_is_forward_iterator<It>{});
+}
+
+/**
+   Build a `list` from a `std::vector`.
+
+   @see from_range(It, It)
+*/
+template<typename T, typename Alloc>
+tmpref<object> from_range(const std::vector<T, Alloc> &values) {
+    return from_range(values.begin(), values.end());
+}
+
+/**
+   Build a `list` from a `std::vector`, moving each value into its
+   conversion. Owning wrappers like `py::tmpref` give their reference to
+   the list.
+
+   @see from_range(It, It)
+*/
+template<typename T, typename Alloc>
+tmpref<object> from_range(std::vector<T, Alloc> &&values) {
+    return from_range(std::make_move_iterator(values.begin()),
+                      std::make_move_iterator(values.end()));
+}
 }
 }
 
@@ -349,5 +607,20 @@ struct typeformat<py::list::object> {
     static inline auto make_arg(T &&t) {
         return std::make_tuple(&PyList_Type, std::forward<T>(t));
     }
+
+    static inline PyTypeObject *exact_type() {
+        return &PyList_Type;
+    }
+
+    static inline bool convert(PyObject *ob, py::list::object &out) {
+        if (!PyList_Check(ob)) {
+            PyErr_Format(PyExc_TypeError,
+                         "must be list, not %.50s",
+                         Py_TYPE(ob)->tp_name);
+            return false;
+        }
+        out = py::object(ob);
+        return true;
+    }
 };
 }
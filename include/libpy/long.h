@@ -251,5 +251,20 @@ struct typeformat<py::long_::object> {
     static inline auto make_arg(T &&t) {
         return std::make_tuple(&PyLong_Type, std::forward<T>(t));
     }
+
+    static inline PyTypeObject *exact_type() {
+        return &PyLong_Type;
+    }
+
+    static inline bool convert(PyObject *ob, py::long_::object &out) {
+        if (!PyLong_Check(ob)) {
+            PyErr_Format(PyExc_TypeError,
+                         "must be int, not %.50s",
+                         Py_TYPE(ob)->tp_name);
+            return false;
+        }
+        out = py::object(ob);
+        return true;
+    }
 };
 }
@@ -1,11 +1,17 @@
 #pragma once
 #include <ostream>
+#include <type_traits>
 
 #include <Python.h>
 
 #include "libpy/utils.h"
 
 #define HAVE_MATMUL (PY_VERSION_HEX >= 0x03500000)
+#define HAVE_VECTORCALL (PY_VERSION_HEX >= 0x03080000)
+
+#if PY_VERSION_HEX < 0x030900A4
+#define Py_SET_SIZE(ob, size) (Py_SIZE(ob) = (size))
+#endif
 
 /**
    A namespace to hold all of the C++ adapted CPython API types, functions, and
@@ -209,11 +215,56 @@ public:
     }
 };
 
+/**
+   A keyword argument to pass to `py::object::operator()`.
+
+   These are created by assigning to a keyword name, for example:
+   `f(a, "key"_kw = b)`.
+
+   This only borrows a reference to the value so it should only be used
+   as an argument to a call expression.
+*/
+template<typename Name>
+class kwarg {
+private:
+    PyObject *value;
+
+public:
+    explicit kwarg(PyObject *value) : value(value) {}
+
+    inline bool is_nonnull() const {
+        return value;
+    }
+
+    inline operator PyObject*() const {
+        return value;
+    }
+};
+
+/**
+   The name of a keyword argument. The name is encoded in the type so that
+   the keyword names for a call can be collected at compile time.
+
+   @see operator""_kw
+*/
+template<typename Name>
+struct kwname {
+    /**
+       Bind a value to this keyword.
+
+       @param value The value to pass for this keyword.
+       @return      The keyword argument.
+    */
+    kwarg<Name> operator=(const object &value) const;
+};
+
 namespace iter {
     template<typename T>
     class iterator;
 }
 
+class attrcache;
+
 /**
    A wrapper around `PyObject*` to provide a C++ interface to the
    CPython API.
@@ -338,6 +389,18 @@ public:
         return ob_binary_func<PyObject_GetAttr>(attr);
     }
 
+    /**
+       Get an attribute through a per call site cache.
+
+       This is equivalent to: `getattr(this, attr)` where `attr` is the
+       name the cache was created with.
+
+       @see attrcache
+       @param cache The cache for the attribute.
+       @return      The value of the attribute.
+    */
+    inline tmpref<object> getattr(attrcache &cache) const;
+
     /**
        Sets an attribute on the object.
 
@@ -536,6 +599,22 @@ public:
     */
     tmpref<object> next() const;
 
+    /**
+       Take up to `n` items out of an iterator in a single loop.
+
+       This is like calling `next` up to `n` times, but the iterator's
+       `tp_iternext` slot is only looked up once.
+
+       @param buffer Storage for at least `n` items. This is filled with
+                     new references to the items taken.
+       @param n      The maximum number of items to take.
+       @return       The number of items taken, which is less than `n`
+                     only if the iterator is exhausted, or -1 with a
+                     Python exception set. On failure the items already
+                     taken are released.
+    */
+    ssize_t next_batch(PyObject **buffer, ssize_t n) const;
+
     /**
        Constant iterator over a py::object.
     */
@@ -770,6 +849,10 @@ public:
 
        This is equivalent to: `this(a, b, ...)`.
 
+       Keyword arguments may be passed after the positional arguments
+       with the `_kw` literal, for example: `this(a, "key"_kw = b)`. This
+       does not allocate a `dict` for the keyword arguments.
+
        @param args The arguments to to pass to this.
        @return     The result of calling the object with the given
                    arguments.
@@ -800,6 +883,24 @@ public:
         return PyObject_Call(ob, args.ob, kwargs.ob);
     }
 
+    /**
+       Call a method of the object.
+
+       This is equivalent to: `this.name(a, b, ...)`.
+
+       Unlike `this.getattr(name)(a, b, ...)`, this does not create a
+       temporary bound method object.
+       Keyword arguments may be passed with the `_kw` literal like in
+       `operator()`.
+
+       @param name The name of the method as a string object.
+       @param args The arguments to pass to the method.
+       @return     The result of calling the method with the given
+                   arguments.
+    */
+    template<typename T, typename... Ts>
+    tmpref<object> call_method(const T &name, const Ts&... args) const;
+
     // refcounting
     /**
        Increment the reference count of the object.
@@ -864,39 +965,378 @@ public:
     tmpref<object> as_tmpref() &&;
 };
 
-namespace _tuple_templates{
-#include "libpy/_tuple_templates.h"
+/**
+   Call `f` by packing the arguments into a `tuple` and a `dict`.
+
+   This is the implementation of `vectorcall` for interpreters which do not
+   support the vectorcall protocol.
+
+   @see vectorcall
+*/
+PyObject *_vectorcall_fallback(PyObject *f,
+                               PyObject *const *args,
+                               std::size_t nargs,
+                               PyObject *kwnames);
+
+/**
+   Call `f` with arguments passed as a C array instead of a `tuple`.
+
+   `args[nargs:]` holds the values for the keyword arguments named in
+   `kwnames`. `args[-1]` must be valid storage which the callee may
+   temporarily overwrite, this lets bound methods prepend `self` without
+   copying the arguments.
+
+   On Python versions without the vectorcall protocol this falls back to
+   `PyObject_Call`.
+
+   @param f       The object to call.
+   @param args    The positional arguments followed by the keyword
+                  argument values.
+   @param nargs   The number of positional arguments.
+   @param kwnames A `tuple` of the keyword argument names or nullptr.
+   @return        The result of calling `f`.
+*/
+inline PyObject *vectorcall(PyObject *f,
+                            PyObject *const *args,
+                            std::size_t nargs,
+                            PyObject *kwnames = nullptr) {
+#if PY_VERSION_HEX >= 0x03090000
+    return PyObject_Vectorcall(f,
+                               args,
+                               nargs | PY_VECTORCALL_ARGUMENTS_OFFSET,
+                               kwnames);
+#elif HAVE_VECTORCALL
+    return _PyObject_Vectorcall(f,
+                                args,
+                                nargs | PY_VECTORCALL_ARGUMENTS_OFFSET,
+                                kwnames);
+#else
+    return _vectorcall_fallback(f, args, nargs, kwnames);
+#endif // HAVE_VECTORCALL
+}
+
+template<typename Name>
+kwarg<Name> kwname<Name>::operator=(const object &value) const {
+    return kwarg<Name>(value);
+}
+
+/**
+   The interned `tuple` of keyword names for a given sequence of
+   `kwname`s.
+
+   There is a single instance of this tuple for each distinct sequence
+   of names so it is only built the first time a call site is executed.
+*/
+template<typename... Names>
+struct _kwnames {
+private:
+    template<char... cs>
+    static PyObject *intern(pyutils::char_sequence<cs...>) {
+        const char name[] = {cs..., '\0'};
+        return PyUnicode_InternFromString(name);
+    }
+
+public:
+    /**
+       Get the names as a Python `tuple`.
+
+       @return A borrowed reference to the names, or nullptr if an
+               exception occured while creating the names.
+    */
+    static PyObject *get() {
+        static PyObject *names = nullptr;
+
+        if (names) {
+            return names;
+        }
+
+        PyObject *items[] = {intern(Names{})...};
+        PyObject *tmp = PyTuple_New(sizeof...(Names));
+        for (std::size_t n = 0; n < sizeof...(Names); ++n) {
+            if (!(tmp && items[n])) {
+                Py_CLEAR(tmp);
+                Py_XDECREF(items[n]);
+                continue;
+            }
+            PyTuple_SET_ITEM(tmp, n, items[n]);
+        }
+        return (names = tmp);
+    }
+};
+
+/**
+   Calls without keyword arguments pass nullptr for the keyword names.
+*/
+template<>
+struct _kwnames<> {
+    static PyObject *get() {
+        return nullptr;
+    }
+};
+
+/**
+   Compile time information about the arguments to
+   `py::object::operator()`.
+*/
+template<typename... Ts>
+struct _call_traits {
+    static constexpr std::size_t npositional = 0;
+    static constexpr std::size_t nkeyword = 0;
+    static constexpr bool keywords_last = true;
+    using kwnames = _kwnames<>;
+};
+
+template<typename N, typename K>
+struct _kwnames_prepend;
+
+template<typename N, typename... Ns>
+struct _kwnames_prepend<N, _kwnames<Ns...>> {
+    using type = _kwnames<N, Ns...>;
+};
+
+template<typename T, typename... Ts>
+struct _call_traits<T, Ts...> {
+private:
+    using tail = _call_traits<Ts...>;
+
+public:
+    static constexpr std::size_t npositional = tail::npositional + 1;
+    static constexpr std::size_t nkeyword = tail::nkeyword;
+    static constexpr bool keywords_last = tail::keywords_last;
+    using kwnames = typename tail::kwnames;
+};
+
+template<typename Name, typename... Ts>
+struct _call_traits<kwarg<Name>, Ts...> {
+private:
+    using tail = _call_traits<Ts...>;
+
+public:
+    static constexpr std::size_t npositional = tail::npositional;
+    static constexpr std::size_t nkeyword = tail::nkeyword + 1;
+    static constexpr bool keywords_last = (tail::keywords_last &&
+                                           !tail::npositional);
+    using kwnames = typename _kwnames_prepend<Name,
+                                              typename tail::kwnames>::type;
+};
+
+/**
+   Call the method `name` of `args[0]` without creating a bound method.
+
+   This is the implementation of `vectorcall_method` for interpreters
+   which do not provide `PyObject_VectorcallMethod`.
+
+   @see vectorcall_method
+*/
+PyObject *_vectorcall_method_fallback(PyObject *name,
+                                      PyObject *const *args,
+                                      std::size_t nargs,
+                                      PyObject *kwnames);
+
+/**
+   Call the method `name` of `args[0]` with the arguments in `args[1:]`.
+
+   This looks up the method like the `LOAD_METHOD` opcode so plain
+   Python functions and method descriptors are called with `args[0]` as
+   `self` instead of creating a bound method object. Like `vectorcall`,
+   `args[-1]` must be valid storage which the callee may temporarily
+   overwrite.
+
+   @param name    The name of the method as a string object.
+   @param args    The object to call the method on, followed by the
+                  positional arguments and the keyword argument values.
+   @param nargs   The number of positional arguments including `args[0]`.
+   @param kwnames A `tuple` of the keyword argument names or nullptr.
+   @return        The result of calling the method.
+*/
+inline PyObject *vectorcall_method(PyObject *name,
+                                   PyObject *const *args,
+                                   std::size_t nargs,
+                                   PyObject *kwnames = nullptr) {
+#if PY_VERSION_HEX >= 0x03090000
+    return PyObject_VectorcallMethod(name,
+                                     args,
+                                     nargs | PY_VECTORCALL_ARGUMENTS_OFFSET,
+                                     kwnames);
+#else
+    return _vectorcall_method_fallback(name, args, nargs, kwnames);
+#endif
 }
 
 template<typename... Ts>
 tmpref<object> object::operator()(const Ts&... args) const {
+    using traits = _call_traits<Ts...>;
+    static_assert(traits::keywords_last,
+                  "positional arguments may not follow keyword arguments");
+
     if (!pyutils::all_nonnull(*this, args...)) {
         pyutils::failed_null_check();
         return nullptr;
     }
 
-    auto pyargs = _tuple_templates::pack(args...);
+    PyObject *kwnames = traits::kwnames::get();
+    if (traits::nkeyword && !kwnames) {
+        return nullptr;
+    }
+
+    // the leading slot is the scratch space for PY_VECTORCALL_ARGUMENTS_OFFSET
+    PyObject *stack[] = {nullptr, static_cast<PyObject*>(args)...};
+    return vectorcall(ob, stack + 1, traits::npositional, kwnames);
+}
 
-    if (!pyargs.is_nonnull()) {
+template<typename T, typename... Ts>
+tmpref<object> object::call_method(const T &name, const Ts&... args) const {
+    using traits = _call_traits<Ts...>;
+    static_assert(traits::keywords_last,
+                  "positional arguments may not follow keyword arguments");
+
+    if (!pyutils::all_nonnull(*this, name, args...)) {
+        pyutils::failed_null_check();
+        return nullptr;
+    }
+
+    PyObject *kwnames = traits::kwnames::get();
+    if (traits::nkeyword && !kwnames) {
         return nullptr;
     }
-    return PyObject_Call(ob, pyargs.ob, nullptr);
+
+    // the leading slot is the scratch space for PY_VECTORCALL_ARGUMENTS_OFFSET
+    PyObject *stack[] = {nullptr, ob, static_cast<PyObject*>(args)...};
+    return vectorcall_method(name, stack + 1, traits::npositional + 1, kwnames);
 }
 
 namespace iter {
+/**
+   Input iterator over a Python object.
+
+   Exact `list`, `tuple` and `dict` objects are stepped directly: lists
+   and tuples are indexed and dicts use `PyDict_Next`. The items are
+   borrowed from the container so they are only valid until the container
+   is modified. Lists are checked against their current size on each step
+   like Python's `list` iterator. Dicts raise a `RuntimeError` if their
+   size changes during iteration.
+
+   Any other object is iterated with `iter()` and the iterator's
+   `tp_iternext` slot. Iteration stops at the end of the sequence or at
+   the first error, so callers should check `PyErr_Occurred()` after the
+   loop.
+*/
 template<typename T>
 class iterator :
     public std::iterator<std::input_iterator_tag, T, void> {
 private:
+    enum class kind {
+        list,
+        tuple,
+        dict,
+        generic,
+    };
+
+    /**
+       The container for the fast paths or the result of `iter()`. This
+       is nullptr once the iterator is exhausted.
+    */
     ownedref<object> it;
+
+    /**
+       The reference owned for the current item when using `tp_iternext`.
+    */
     tmpref<object> last;
 
+    /**
+       The current item, borrowed from `it` or `last`.
+    */
+    object current;
+
+    kind how;
+    Py_ssize_t pos;
+    Py_ssize_t dict_size;
+
+    void finish() {
+        it.decref();
+        it.ob = nullptr;
+        current.ob = nullptr;
+    }
+
+    void step() {
+        PyObject *ob = it;
+        switch (how) {
+        case kind::list:
+            if (pos < PyList_GET_SIZE(ob)) {
+                current.ob = PyList_GET_ITEM(ob, pos++);
+                return;
+            }
+            break;
+        case kind::tuple:
+            if (pos < PyTuple_GET_SIZE(ob)) {
+                current.ob = PyTuple_GET_ITEM(ob, pos++);
+                return;
+            }
+            break;
+        case kind::dict: {
+            if (PyDict_Size(ob) != dict_size) {
+                PyErr_SetString(PyExc_RuntimeError,
+                                "dictionary changed size during iteration");
+                break;
+            }
+            PyObject *key;
+            if (PyDict_Next(ob, &pos, &key, nullptr)) {
+                current.ob = key;
+                return;
+            }
+            break;
+        }
+        case kind::generic:
+            last.decref();
+            last.ob = Py_TYPE(ob)->tp_iternext(ob);
+            if (last.is_nonnull()) {
+                current.ob = last.ob;
+                return;
+            }
+            // `PyIter_Next` without the extra call
+            if (PyErr_Occurred() &&
+                PyErr_ExceptionMatches(PyExc_StopIteration)) {
+                PyErr_Clear();
+            }
+            break;
+        }
+        finish();
+    }
+
 protected:
-    iterator(T &&t)
-        : it(t), last(std::move(it.next())) {
-        if (!last.is_nonnull()) {
-            it.ob = nullptr;
+    iterator(const T &iterable)
+        : it(nullptr),
+          last(nullptr),
+          current(nullptr),
+          how(kind::generic),
+          pos(0),
+          dict_size(0) {
+        PyObject *ob = iterable;
+        if (!ob) {
+            pyutils::failed_null_check();
+            return;
+        }
+
+        if (PyList_CheckExact(ob)) {
+            how = kind::list;
+        }
+        else if (PyTuple_CheckExact(ob)) {
+            how = kind::tuple;
+        }
+        else if (PyDict_CheckExact(ob)) {
+            how = kind::dict;
+            dict_size = PyDict_Size(ob);
+        }
+        else {
+            it.ob = PyObject_GetIter(ob);
+            if (it.is_nonnull()) {
+                step();
+            }
+            return;
         }
+        Py_INCREF(ob);
+        it.ob = ob;
+        step();
     }
 
 public:
@@ -905,20 +1345,50 @@ public:
     /**
        Default constructor for cend.
     */
-    iterator() : it(nullptr), last(nullptr) {}
-    iterator(const iterator &t) : it(t.it), last(t.last.incref()) {}
+    iterator()
+        : it(nullptr),
+          last(nullptr),
+          current(nullptr),
+          how(kind::generic),
+          pos(0),
+          dict_size(0) {}
+
+    iterator(const iterator &t)
+        : it(t.it),
+          last(t.last.incref()),
+          current(t.current),
+          how(t.how),
+          pos(t.pos),
+          dict_size(t.dict_size) {}
+
     iterator(iterator &&t)
-        : it(std::move(t.it)), last(std::move(t.last)) {}
+        : it(std::move(t.it)),
+          last(std::move(t.last)),
+          current(t.current),
+          how(t.how),
+          pos(t.pos),
+          dict_size(t.dict_size) {
+        t.current.ob = nullptr;
+    }
 
     iterator &operator=(const iterator &t) {
         it = t.it;
         last = t.last;
+        current = t.current;
+        how = t.how;
+        pos = t.pos;
+        dict_size = t.dict_size;
         return *this;
     }
 
     iterator &operator=(iterator &&t) {
         it = std::move(t.it);
         last = std::move(t.last);
+        current = t.current;
+        how = t.how;
+        pos = t.pos;
+        dict_size = t.dict_size;
+        t.current.ob = nullptr;
         return *this;
     }
 
@@ -932,21 +1402,16 @@ public:
     }
 
     const object &operator*() const {
-        return last;
+        return current;
     }
 
     const object *operator->() const {
-        return &last;
+        return &current;
     }
 
     iterator &operator++() {
         if (it.is_nonnull()) {
-            last.decref();
-            last = it.next();
-            if (!last.is_nonnull()) {
-                it.decref();
-                it.ob = nullptr;
-            }
+            step();
         }
         return *this;
     }
@@ -983,6 +1448,19 @@ const object &operator""_p(const wchar_t *cs, std::size_t len);
 */
 const object &operator""_p(long double d);
 
+/**
+   Operator overload for keyword argument names.
+
+   This is used to pass keyword arguments to `py::object::operator()`,
+   for example: `f(a, "key"_kw = b)`.
+*/
+template<typename C, C... cs>
+constexpr kwname<pyutils::char_sequence<cs...>> operator""_kw() {
+    static_assert(std::is_same<C, char>::value,
+                  "keyword names must be narrow strings");
+    return {};
+}
+
 /**
    ostream writing for objects.
 
@@ -0,0 +1,159 @@
+#pragma once
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <Python.h>
+
+#include "libpy/automethod.h"
+#include "libpy/automethod_vectorized.h"
+#include "libpy/list.h"
+#include "libpy/object.h"
+#include "libpy/to_python.h"
+#include "libpy/utils.h"
+
+namespace pyutils {
+/**
+   Run `body` over `[0, n)` in blocks of `chunk` items on the shared
+   thread pool. The calling thread also runs blocks and this returns once
+   every block is done.
+
+   This does not touch the GIL; `body` must not call into Python. When
+   this is called from a pool thread the blocks are run serially on that
+   thread instead of waiting on the pool.
+
+   @param n     The number of items.
+   @param chunk The number of items in each block, 0 picks a size from
+                `n` and the number of threads.
+   @param body  Called with the `[begin, end)` of each block.
+   @return      The first exception thrown by `body`, or nullptr.
+*/
+std::exception_ptr
+_parallel_for(std::size_t n,
+              std::size_t chunk,
+              const std::function<void(std::size_t, std::size_t)> &body);
+
+/**
+   The number of threads, including the calling thread, used by
+   `_parallel_for`. This defaults to the number of hardware threads.
+*/
+std::size_t parallel_threads();
+
+/**
+   Set the number of threads used by `_parallel_for`. Worker threads are
+   started when a job first needs them and are kept for the life of the
+   process.
+
+   @param n The number of threads including the calling thread, values
+            less than 1 are treated as 1.
+*/
+void set_parallel_threads(std::size_t n);
+}
+
+namespace py {
+/**
+   Apply `f` to every item of a `list`, `tuple` or one dimensional buffer
+   on the shared thread pool.
+
+   The items are converted to `T` with the `automethod` converters, or
+   read in place from a buffer of `T`, while holding the GIL. The GIL is
+   then released while `f` runs over the native values in blocks, and
+   reacquired once to box the results into a list allocated at its final
+   size with `to_python`.
+
+   `f` is called concurrently from several threads and may not take or
+   return Python objects. Its result type must be default constructible.
+   If `f` throws, the exception is raised as a `RuntimeError`.
+
+   @tparam T     The native type of the items, this is deduced from `f`
+                 when it is a function pointer or a non-generic lambda.
+   @param values The values to transform.
+   @param f      The function to apply.
+   @param chunk  The number of items each thread takes at a time, 0 picks
+                 a size automatically.
+   @return       A new list of the results, or nullptr with a Python
+                 exception set.
+*/
+template<typename T, typename F>
+tmpref<list::object> parallel_transform(const py::object &values,
+                                        F &&f,
+                                        std::size_t chunk = 0) {
+    using R = std::decay_t<decltype(f(std::declval<const T&>()))>;
+    static_assert(!pyutils::_is_python_object<T>::value &&
+                  !pyutils::_is_python_object<R>::value,
+                  "parallel_transform may not take or return Python objects");
+
+    PyObject *ob = values;
+    if (!ob) {
+        pyutils::failed_null_check();
+        return nullptr;
+    }
+    if (!(PyList_Check(ob) || PyTuple_Check(ob) || PyObject_CheckBuffer(ob))) {
+        PyErr_Format(PyExc_TypeError,
+                     "expected a list, tuple or buffer, got %.50s",
+                     Py_TYPE(ob)->tp_name);
+        return nullptr;
+    }
+
+    pyutils::_vectorized_arg<T> in;
+    if (!in.load(ob)) {
+        return nullptr;
+    }
+    std::size_t len = in.size;
+    std::unique_ptr<R[]> out(new R[len]);
+
+    std::exception_ptr error;
+    {
+        pyutils::_gil_released released;
+        const T *data = in.data;
+        R *results = out.get();
+        error = pyutils::_parallel_for(
+            len,
+            chunk,
+            [&](std::size_t begin, std::size_t end) {
+                for (std::size_t ix = begin; ix < end; ++ix) {
+                    results[ix] = f(data[ix]);
+                }
+            });
+    }
+
+    if (error) {
+        try {
+            std::rethrow_exception(error);
+        }
+        catch (const std::exception &e) {
+            PyErr_SetString(PyExc_RuntimeError, e.what());
+        }
+        catch (...) {
+            PyErr_SetString(PyExc_RuntimeError,
+                            "unknown error in parallel_transform");
+        }
+        return nullptr;
+    }
+
+    PyObject *list = PyList_New(len);
+    if (!list) {
+        return nullptr;
+    }
+    for (std::size_t ix = 0; ix < len; ++ix) {
+        PyObject *item = pyutils::to_python(std::move(out[ix]));
+        if (!item) {
+            Py_DECREF(list);
+            return nullptr;
+        }
+        PyList_SET_ITEM(list, ix, item);
+    }
+    return list;
+}
+
+template<typename F>
+tmpref<list::object> parallel_transform(const py::object &values,
+                                        F &&f,
+                                        std::size_t chunk = 0) {
+    using T = typename pyutils::_unary_argument<std::decay_t<F>>::type;
+    return parallel_transform<T>(values, std::forward<F>(f), chunk);
+}
+}
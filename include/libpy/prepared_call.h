@@ -0,0 +1,144 @@
+#pragma once
+#include <cstddef>
+
+#include <Python.h>
+
+#include "libpy/object.h"
+#include "libpy/utils.h"
+
+namespace py {
+/**
+   A callable bound together with the storage for `N` positional
+   arguments.
+
+   This is meant for calling the same Python callable many times with
+   the same number of arguments, for example once per row. The calling
+   convention of the callable is resolved once when the `prepared_call`
+   is created and each `invoke` only writes the argument pointers into
+   an array on the C++ stack.
+
+   Callables which support the vectorcall protocol are called directly
+   through their vectorcall function. Other callables are called with
+   `tp_call` and an argument `tuple` which is reused between calls as
+   long as the callee does not keep a reference to it.
+*/
+template<std::size_t N>
+class prepared_call {
+private:
+    ownedref<object> callable;
+
+#if HAVE_VECTORCALL
+    vectorcallfunc func;
+#endif // HAVE_VECTORCALL
+
+    /**
+       The `tuple` passed to `tp_call`. This is only owned by us between
+       calls.
+    */
+    PyObject *args;
+
+    /**
+       Call `callable` with `tp_call`, reusing `args` when possible.
+
+       The cached `tuple` is detached for the duration of the call so
+       that a reentrant call to the same `prepared_call` does not
+       overwrite the arguments which the outer callee is still using.
+    */
+    PyObject *tp_call(PyObject *const *argv) {
+        PyObject *t = args;
+        args = nullptr;
+        if (!t && !(t = PyTuple_New(N))) {
+            return nullptr;
+        }
+
+        for (std::size_t n = 0; n < N; ++n) {
+            Py_INCREF(argv[n]);
+            PyTuple_SET_ITEM(t, n, argv[n]);
+        }
+
+        PyObject *result = PyObject_Call(callable, t, nullptr);
+
+        if (Py_REFCNT(t) != 1 || args) {
+            // the callee kept the tuple alive, it now owns the arguments;
+            // or a reentrant call already put back its own tuple
+            Py_DECREF(t);
+        }
+        else {
+            // don't keep the arguments alive until the next call
+            for (std::size_t n = 0; n < N; ++n) {
+                PyObject *item = PyTuple_GET_ITEM(t, n);
+                PyTuple_SET_ITEM(t, n, nullptr);
+                Py_DECREF(item);
+            }
+            args = t;
+        }
+        return result;
+    }
+
+public:
+    /**
+       Prepare to call `callable` with `N` positional arguments.
+
+       @param callable The object to call.
+    */
+    explicit prepared_call(const object &callable)
+        : callable(callable),
+#if HAVE_VECTORCALL
+          func(nullptr),
+#endif // HAVE_VECTORCALL
+          args(nullptr) {
+#if PY_VERSION_HEX >= 0x03090000
+        if (callable.is_nonnull()) {
+            func = PyVectorcall_Function(callable);
+        }
+#elif HAVE_VECTORCALL
+        if (callable.is_nonnull()) {
+            func = _PyVectorcall_Function(callable);
+        }
+#endif
+    }
+
+    prepared_call(const prepared_call&) = delete;
+    prepared_call &operator=(const prepared_call&) = delete;
+
+    ~prepared_call() {
+        Py_XDECREF(args);
+    }
+
+    /**
+       Call the bound callable.
+
+       This is equivalent to: `callable(a, b, ...)`.
+
+       @param args The `N` arguments to pass to the callable.
+       @return     The result of calling the callable with the given
+                   arguments.
+    */
+    template<typename... Ts>
+    tmpref<object> invoke(const Ts&... args) {
+        static_assert(sizeof...(Ts) == N,
+                      "invoke must be called with exactly N arguments");
+
+        if (!pyutils::all_nonnull(callable, args...)) {
+            pyutils::failed_null_check();
+            return nullptr;
+        }
+
+        // The leading slot is the scratch space for
+        // PY_VECTORCALL_ARGUMENTS_OFFSET. This is local so that a
+        // reentrant call does not overwrite the arguments of the outer
+        // call.
+        PyObject *stack[] = {nullptr, static_cast<PyObject*>(args)...};
+
+#if HAVE_VECTORCALL
+        if (func) {
+            return func(callable,
+                        stack + 1,
+                        N | PY_VECTORCALL_ARGUMENTS_OFFSET,
+                        nullptr);
+        }
+#endif // HAVE_VECTORCALL
+        return tp_call(stack + 1);
+    }
+};
+}
@@ -0,0 +1,492 @@
+#pragma once
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "libpy/object.h"
+#include "libpy/to_python.h"
+#include "libpy/type.h"
+
+/**
+   Python 3.13 moved `_PySet_Update` into the internal API. On newer
+   versions `update` adds each item with `PySet_Add`.
+*/
+#define HAVE_SET_UPDATE (PY_VERSION_HEX < 0x030D0000)
+
+namespace py {
+namespace set {
+/**
+   A subclass of `py::object` for optional sets. This wraps both `set`
+   and `frozenset` objects; the methods which modify the set require a
+   `set`.
+*/
+class object : public py::object {
+private:
+    /**
+       Function called to verify that `ob` is a set or frozenset and
+       correctly raise a python exception otherwies.
+    */
+    void set_check();
+
+    /**
+       Add the items of a Python iterable.
+    */
+    int update_iterable(PyObject *iterable) const;
+
+    template<typename It>
+    static void reserve_for(It first, It last, std::vector<bool> &out) {
+        reserve_for(first,
+                    last,
+                    out,
+                    pyutils::_is_forward_iterator<It>{});
+    }
+
+    template<typename It>
+    static void
+    reserve_for(It first, It last, std::vector<bool> &out, std::true_type) {
+        out.reserve(std::distance(first, last));
+    }
+
+    template<typename It>
+    static void reserve_for(It, It, std::vector<bool>&, std::false_type) {}
+
+    /**
+       Python iterators stop at the first error instead of reporting it,
+       check for one after a loop over an input iterator. Callers set
+       aside any exception which was already pending with
+       `pyutils::_pending_error` so that only a new one is seen here.
+    */
+    template<typename It>
+    static bool iteration_failed() {
+        return !pyutils::_is_forward_iterator<It>::value && PyErr_Occurred();
+    }
+public:
+    friend class py::tmpref<object>;
+
+    /**
+       Default constructor. This will set `ob` to nullptr.
+    */
+    object();
+
+    /**
+       Constructor from `PyObject*`. If `pob` is not a `set` or
+       `frozenset` then `ob` will be set to `nullptr`.
+    */
+    object(PyObject *pob);
+
+    /**
+       Constructor from `py::object`. If `pob` is not a `set` or
+       `frozenset` then `ob` will be set to `nullptr`.
+    */
+    object(const py::object &pob);
+
+    object(const object &cpfrom);
+    object(object &&mvfrom) noexcept;
+
+    using py::object::operator=;
+
+    /**
+       Get the number of items in the set.
+
+       This is equivalent to `len(this)`.
+
+       @return The length of the object or -1 if an exception occured.
+    */
+    py::ssize_t len() const;
+
+    /**
+       Check if the set has an item. This calls the set's lookup
+       directly instead of dispatching through `__contains__`.
+
+       This is equivalent to: `key in this`.
+
+       @param key The item to check.
+       @return    1 if the item is present, 0 if it is not, -1 if an
+                  exception occured.
+    */
+    int contains(const py::object &key) const;
+
+    /**
+       Check if each value in `[first, last)` is in the set. Each value is
+       converted with `to_python` and looked up directly.
+
+       @param first The start of the values. Python iterators are
+                    consumed, so the result is only reserved up front
+                    for forward iterators.
+       @param last  The end of the values.
+       @param out   Cleared and filled with whether each value is in the
+                    set.
+       @return      zero on success, -1 on failure with a Python
+                    exception set.
+    */
+    template<typename It>
+    int contains_many(It first, It last, std::vector<bool> &out) const {
+        out.clear();
+        if (!is_nonnull()) {
+            pyutils::failed_null_check();
+            return -1;
+        }
+        reserve_for(first, last, out);
+        pyutils::_pending_error pending;
+        for (; first != last; ++first) {
+            tmpref<py::object> key(pyutils::to_python(*first));
+            if (!key.is_nonnull()) {
+                return -1;
+            }
+            int found = PySet_Contains(ob, key);
+            if (found < 0) {
+                return -1;
+            }
+            out.push_back(found);
+        }
+        return iteration_failed<It>() ? -1 : 0;
+    }
+
+    /**
+       Check if each value of a C++ range, or a `py::list::object` or
+       `py::tuple::object`, is in the set.
+
+       @see contains_many(It, It, std::vector<bool>&)
+    */
+    template<typename R>
+    int contains_many(const R &range, std::vector<bool> &out) const {
+        using std::begin;
+        using std::end;
+        return contains_many(begin(range), end(range), out);
+    }
+
+    /**
+       Add an item to the set.
+
+       @param key The item to add.
+       @return    zero on success, -1 on failure.
+    */
+    int add(const py::object &key) const;
+
+    /**
+       Remove an item from the set if it is present.
+
+       @param key The item to remove.
+       @return    1 if the item was removed, 0 if it was not present, -1
+                  if an exception occured.
+    */
+    int discard(const py::object &key) const;
+
+    /**
+       Add the items of a Python iterable.
+
+       This is equivalent to: `this.update(other)`, without looking up the
+       method.
+
+       @param other The items to add.
+       @return      zero on success, -1 on failure.
+    */
+    int update(const py::object &other) const;
+
+    /**
+       Add the values in `[first, last)`, each converted with
+       `to_python`.
+
+       @param first The start of the values.
+       @param last  The end of the values.
+       @return      zero on success, -1 on failure. Values added before a
+                    failure are kept.
+    */
+    template<typename It>
+    int update(It first, It last) const {
+        if (!is_nonnull()) {
+            pyutils::failed_null_check();
+            return -1;
+        }
+        pyutils::_pending_error pending;
+        for (; first != last; ++first) {
+            tmpref<py::object> key(pyutils::to_python(*first));
+            if (!key.is_nonnull() || PySet_Add(ob, key)) {
+                return -1;
+            }
+        }
+        return iteration_failed<It>() ? -1 : 0;
+    }
+
+    /**
+       Add the values of a C++ range.
+
+       @see update(It, It)
+    */
+    template<typename R,
+             typename = std::enable_if_t<
+                 !std::is_base_of<py::object, std::decay_t<R>>::value &&
+                 !std::is_pointer<std::decay_t<R>>::value>>
+    int update(const R &range) const {
+        using std::begin;
+        using std::end;
+        return update(begin(range), end(range));
+    }
+
+    /**
+       Remove the items of a Python iterable.
+
+       This is equivalent to: `this.difference_update(other)`, without
+       looking up the method.
+
+       @param other The items to remove.
+       @return      zero on success, -1 on failure.
+    */
+    int difference_update(const py::object &other) const;
+
+    /**
+       Remove the values in `[first, last)`, each converted with
+       `to_python`.
+
+       @param first The start of the values.
+       @param last  The end of the values.
+       @return      zero on success, -1 on failure. Values removed before
+                    a failure stay removed.
+    */
+    template<typename It>
+    int difference_update(It first, It last) const {
+        if (!is_nonnull()) {
+            pyutils::failed_null_check();
+            return -1;
+        }
+        pyutils::_pending_error pending;
+        for (; first != last; ++first) {
+            tmpref<py::object> key(pyutils::to_python(*first));
+            if (!key.is_nonnull() || PySet_Discard(ob, key) < 0) {
+                return -1;
+            }
+        }
+        return iteration_failed<It>() ? -1 : 0;
+    }
+
+    /**
+       Remove the values of a C++ range.
+
+       @see difference_update(It, It)
+    */
+    template<typename R,
+             typename = std::enable_if_t<
+                 !std::is_base_of<py::object, std::decay_t<R>>::value &&
+                 !std::is_pointer<std::decay_t<R>>::value>>
+    int difference_update(const R &range) const {
+        using std::begin;
+        using std::end;
+        return difference_update(begin(range), end(range));
+    }
+
+    /**
+       Coerce to a `nonnull` object.
+
+       @see nonnull
+       @throws pyutil::bad_nonnull Thrown when `ob == nullptr`.
+       @return this converted to a `nonnull` object.
+    */
+    nonnull<object> as_nonnull() const;
+
+    /**
+       Create a temporary reference. This is a reference that will
+       decref the object when it is destroyed.
+
+       @return this converted into a tmpref.
+    */
+    tmpref<object> as_tmpref() &&;
+};
+
+/**
+   The type of Python `set` objects.
+
+   This is equivalent to: `set`.
+*/
+extern const type::object<set::object> type;
+
+/**
+   The type of Python `frozenset` objects.
+
+   This is equivalent to: `frozenset`.
+*/
+extern const type::object<set::object> frozenset_type;
+
+/**
+   Check if an object is an instance of `set` or `frozenset`.
+
+   @param t The object to check
+   @return  1 if `ob` is an instance of `set` or `frozenset`, 0 if `ob`
+            is not, -1 if an exception occured.
+*/
+template<typename T>
+inline int check(const T &t) {
+    if (!t.is_nonnull()) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    return PyAnySet_Check(t);
+}
+
+inline int check(const nonnull<object>&) {
+    return 1;
+}
+
+/**
+   Check if an object is an instance of `set` or `frozenset` but not a
+   subclass.
+
+   @param t The object to check
+   @return  1 if `ob` is exactly a `set` or `frozenset`, 0 if `ob` is
+            not, -1 if an exception occured.
+*/
+template<typename T>
+inline int checkexact(const T &t) {
+    if (!t.is_nonnull()) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    return PyAnySet_CheckExact(t);
+}
+
+inline int checkexact(const nonnull<object>&) {
+    return 1;
+}
+}
+
+/**
+   A `py::set::object` where `ob` is known to be nonnull.
+   This is used to skip null checks for performance.
+
+   This class should be used where users want to trade the ability to
+   write a nested expression for perfomance.
+*/
+template<>
+class nonnull<set::object> : public set::object {
+protected:
+    nonnull() = delete;
+    explicit nonnull(PyObject *ob) : set::object(ob) {}
+public:
+    friend class object;
+
+    nonnull(const nonnull &cpfrom) : set::object(cpfrom) {}
+    nonnull(nonnull &&mvfrom) noexcept : set::object(mvfrom.ob) {
+        mvfrom.ob = nullptr;
+    }
+
+    nonnull &operator=(const nonnull &cpfrom) {
+        nonnull<set::object> tmp(cpfrom);
+        return (*this = std::move(tmp));
+    }
+
+    nonnull &operator=(nonnull &&mvfrom) noexcept {
+        ob = mvfrom.ob;
+        mvfrom.ob = nullptr;
+        return *this;
+    }
+
+    /**
+       Get the number of items in the set.
+
+       This is equivalent to `len(this)`.
+
+       @return The length of the object.
+    */
+    py::ssize_t len() const {
+        return PySet_GET_SIZE(ob);
+    }
+};
+
+namespace set {
+template<typename It>
+tmpref<object> _from_range(It first, It last, std::true_type) {
+    py::ssize_t len = std::distance(first, last);
+    tmpref<py::object> items(PyList_New(len));
+    if (!items.is_nonnull()) {
+        return nullptr;
+    }
+    for (py::ssize_t ix = 0; ix < len; ++ix, ++first) {
+        PyObject *item = pyutils::to_python(*first);
+        if (!item) {
+            return nullptr;
+        }
+        PyList_SET_ITEM(static_cast<PyObject*>(items), ix, item);
+    }
+    return PySet_New(items);
+}
+
+template<typename It>
+tmpref<object> _from_range(It first, It last, std::false_type) {
+    tmpref<object> out(PySet_New(nullptr));
+    if (!out.is_nonnull() || out.update(first, last)) {
+        return nullptr;
+    }
+    return out;
+}
+
+/**
+   Build a `set` from the values in `[first, last)`, each converted with
+   `to_python`.
+
+   CPython has no API to presize a set, so the values are first
+   converted into a list allocated at its final size which the set is
+   then built from in one C level pass.
+
+   Input iterators, like the iterator of a Python generator, are added
+   to an empty set one at a time instead.
+
+   @param first The start of the values.
+   @param last  The end of the values.
+   @return      The new set, or nullptr with a Python exception set.
+*/
+template<typename It>
+tmpref<object> from_range(It first, It last) {
+    return _from_range(first, last, pyutils::_is_forward_iterator<It>{});
+}
+
+/**
+   Build a `set` from a C++ range.
+
+   @see from_range(It, It)
+*/
+template<typename R,
+         typename = std::enable_if_t<
+             !std::is_base_of<py::object, std::decay_t<R>>::value &&
+             !std::is_pointer<std::decay_t<R>>::value>>
+tmpref<object> from_range(const R &range) {
+    using std::begin;
+    using std::end;
+    return from_range(begin(range), end(range));
+}
+}
+}
+
+namespace pyutils {
+template<typename T>
+struct typeformat;
+
+template<>
+struct typeformat<py::set::object> {
+    static char_sequence<'O'> cs;
+
+    template<typename T>
+    static inline auto make_arg(T &&t) {
+        return std::make_tuple(std::forward<T>(t));
+    }
+
+    /**
+       Both `set` and `frozenset` are converted so both select an
+       overload.
+    */
+    static inline bool exact_match(PyObject *ob) {
+        return PyAnySet_CheckExact(ob);
+    }
+
+    static inline bool convert(PyObject *ob, py::set::object &out) {
+        if (!PyAnySet_Check(ob)) {
+            PyErr_Format(PyExc_TypeError,
+                         "must be set or frozenset, not %.50s",
+                         Py_TYPE(ob)->tp_name);
+            return false;
+        }
+        out = py::object(ob);
+        return true;
+    }
+};
+}
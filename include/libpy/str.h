@@ -0,0 +1,297 @@
+#pragma once
+#include <tuple>
+#include <utility>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#else
+#include <experimental/string_view>
+#endif
+
+#include "libpy/object.h"
+#include "libpy/type.h"
+
+namespace py {
+namespace str {
+#if __cplusplus >= 201703L
+using string_view = std::string_view;
+#else
+using string_view = std::experimental::string_view;
+#endif
+
+/**
+   A subclass of `py::object` for optional strings.
+
+   The views and raw data returned by these methods point into the
+   string's own storage and are valid as long as the string is alive.
+*/
+class object : public py::object {
+private:
+    /**
+       Function called to verify that `ob` is a str and
+       correctly raise a python exception otherwies.
+    */
+    void str_check();
+
+    /**
+       Make sure the canonical representation of a nonnull string exists.
+       Strings created through the legacy `Py_UNICODE` API before 3.12
+       may not have one until this is called.
+    */
+    inline bool ready() const {
+#if PY_VERSION_HEX < 0x030C0000
+        return PyUnicode_READY(ob) == 0;
+#else
+        return true;
+#endif
+    }
+public:
+    friend class py::tmpref<object>;
+
+    /**
+       Default constructor. This will set `ob` to nullptr.
+    */
+    object();
+
+    /**
+       Constructor from `PyObject*`. If `pob` is not a `str` then
+       `ob` will be set to `nullptr`.
+    */
+    object(PyObject *pob);
+
+    /**
+       Constructor from `py::object`. If `pob` is not a `str` then
+       `ob` will be set to `nullptr`.
+    */
+    object(const py::object &pob);
+
+    object(const object &cpfrom);
+    object(object &&mvfrom) noexcept;
+
+    using py::object::operator=;
+
+    /**
+       Get the number of code points in the string.
+
+       This is equivalent to `len(this)`.
+
+       @return The length of the object or -1 if an exception occured.
+    */
+    py::ssize_t len() const;
+
+    /**
+       Get the hash of the string. Strings cache their hash so after the
+       first call this is a field read.
+
+       This is equivalent to: `hash(this)`.
+
+       @return The hash for the object or -1 if an exception occured.
+    */
+    hash_t hash() const;
+
+    /**
+       Check if every code point in the string is ASCII.
+
+       @return 1 if the string is ASCII, 0 if it is not, -1 if an
+               exception occured.
+    */
+    int is_ascii() const;
+
+    /**
+       Get the storage kind of the string: `PyUnicode_1BYTE_KIND`,
+       `PyUnicode_2BYTE_KIND` or `PyUnicode_4BYTE_KIND`. This is the width
+       of each code point in `data()`.
+
+       @return The kind of the string, or -1 if an exception occured.
+    */
+    int kind() const;
+
+    /**
+       Get the code points of the string, `len()` values of the width
+       given by `kind()`.
+
+       @return The string's storage, or nullptr if an exception occured.
+    */
+    const void *data() const;
+
+    /**
+       Get the code points of a string of kind `PyUnicode_1BYTE_KIND`,
+       which holds Latin-1 text.
+
+       @return The string's storage, or nullptr with a `ValueError` set
+               if the string has a different kind.
+    */
+    const Py_UCS1 *ucs1() const;
+
+    /**
+       Get the code points of a string of kind `PyUnicode_2BYTE_KIND`.
+
+       @return The string's storage, or nullptr with a `ValueError` set
+               if the string has a different kind.
+    */
+    const Py_UCS2 *ucs2() const;
+
+    /**
+       Get the code points of a string of kind `PyUnicode_4BYTE_KIND`.
+
+       @return The string's storage, or nullptr with a `ValueError` set
+               if the string has a different kind.
+    */
+    const Py_UCS4 *ucs4() const;
+
+    /**
+       Get the string as UTF-8 without copying.
+
+       ASCII strings are their own UTF-8 so the view points at the
+       string's storage. Other strings are encoded once and the encoding
+       is cached on the string by CPython.
+
+       @return A view of the UTF-8 encoding. If an exception occured,
+               for example because the string holds lone surrogates, the
+               view's `data()` is nullptr.
+    */
+    string_view utf8() const;
+
+    /**
+       Coerce to a `nonnull` object.
+
+       @see nonnull
+       @throws pyutil::bad_nonnull Thrown when `ob == nullptr`.
+       @return this converted to a `nonnull` object.
+    */
+    nonnull<object> as_nonnull() const;
+
+    /**
+       Create a temporary reference. This is a reference that will
+       decref the object when it is destroyed.
+
+       @return this converted into a tmpref.
+    */
+    tmpref<object> as_tmpref() &&;
+};
+
+/**
+   The type of Python `str` objects.
+
+   This is equivalent to: `str`.
+*/
+extern const type::object<str::object> type;
+
+/**
+   Check if an object is an instance of `str`.
+
+   @param t The object to check
+   @return  1 if `ob` is an instance of `str`, 0 if `ob` is not an
+            instance of `str`, -1 if an exception occured.
+*/
+template<typename T>
+inline int check(const T &t) {
+    if (!t.is_nonnull()) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    return PyUnicode_Check(t);
+}
+
+inline int check(const nonnull<object>&) {
+    return 1;
+}
+
+/**
+   Check if an object is an instance of `str` but not a subclass.
+
+   @param t The object to check
+   @return  1 if `ob` is an instance of `str`, 0 if `ob` is not an
+            instance of `str`, -1 if an exception occured.
+*/
+template<typename T>
+inline int checkexact(const T &t) {
+    if (!t.is_nonnull()) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    return PyUnicode_CheckExact(t);
+}
+
+inline int checkexact(const nonnull<object>&) {
+    return 1;
+}
+}
+
+/**
+   A `py::str::object` where `ob` is known to be nonnull.
+   This is used to skip null checks for performance.
+
+   This class should be used where users want to trade the ability to
+   write a nested expression for perfomance.
+*/
+template<>
+class nonnull<str::object> : public str::object {
+protected:
+    nonnull() = delete;
+    explicit nonnull(PyObject *ob) : str::object(ob) {}
+public:
+    friend class object;
+
+    nonnull(const nonnull &cpfrom) : str::object(cpfrom) {}
+    nonnull(nonnull &&mvfrom) noexcept : str::object(mvfrom.ob) {
+        mvfrom.ob = nullptr;
+    }
+
+    nonnull &operator=(const nonnull &cpfrom) {
+        nonnull<str::object> tmp(cpfrom);
+        return (*this = std::move(tmp));
+    }
+
+    nonnull &operator=(nonnull &&mvfrom) noexcept {
+        ob = mvfrom.ob;
+        mvfrom.ob = nullptr;
+        return *this;
+    }
+
+    /**
+       Get the UTF-8 view of an ASCII string, or fall back to encoding
+       the string.
+
+       @see str::object::utf8
+    */
+    str::string_view utf8() const {
+        if (PyUnicode_IS_COMPACT_ASCII(ob)) {
+            return str::string_view(
+                reinterpret_cast<const char*>(PyUnicode_DATA(ob)),
+                PyUnicode_GET_LENGTH(ob));
+        }
+        return str::object::utf8();
+    }
+};
+}
+
+namespace pyutils {
+template<typename T>
+struct typeformat;
+
+template<>
+struct typeformat<py::str::object> {
+    static char_sequence<'O'> cs;
+
+    template<typename T>
+    static inline auto make_arg(T &&t) {
+        return std::make_tuple(std::forward<T>(t));
+    }
+
+    static inline PyTypeObject *exact_type() {
+        return &PyUnicode_Type;
+    }
+
+    static inline bool convert(PyObject *ob, py::str::object &out) {
+        if (!PyUnicode_Check(ob)) {
+            PyErr_Format(PyExc_TypeError,
+                         "must be str, not %.50s",
+                         Py_TYPE(ob)->tp_name);
+            return false;
+        }
+        out = py::object(ob);
+        return true;
+    }
+};
+}
@@ -0,0 +1,218 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <Python.h>
+
+#include "libpy/object.h"
+
+namespace pyutils {
+/**
+   Conversion from a C++ value to a new reference to a Python object.
+
+   Specializations provide `static PyObject *f(T)` which returns a new
+   reference or nullptr with a Python exception set. The default case is
+   left undefined to generate a compile-time error if you attempt to
+   convert a type that has no conversion.
+
+   @see to_python
+*/
+template<typename T, typename = void>
+struct to_python_converter;
+
+/**
+   Convert a C++ value into a Python object.
+
+   @param value The value to convert. Owning wrappers passed as rvalues
+                give their reference to the result.
+   @return      A new reference to the converted value, or nullptr with a
+                Python exception set.
+*/
+template<typename T>
+inline PyObject *to_python(T &&value) {
+    return to_python_converter<std::decay_t<T>>::f(std::forward<T>(value));
+}
+
+/**
+   A `PyObject*` is assumed to already be a new reference and is returned
+   unchanged.
+*/
+template<>
+struct to_python_converter<PyObject*> {
+    static inline PyObject *f(PyObject *ob) {
+        return ob;
+    }
+};
+
+/**
+   `bool` returns the `True` or `False` singletons.
+*/
+template<>
+struct to_python_converter<bool> {
+    static inline PyObject *f(bool value) {
+        PyObject *out = value ? Py_True : Py_False;
+        Py_INCREF(out);
+        return out;
+    }
+};
+
+/**
+   Signed integral types use the narrowest constructor which can hold
+   the value. Small values are served from CPython's small int cache.
+*/
+template<typename T>
+struct to_python_converter<
+    T,
+    std::enable_if_t<std::is_integral<T>::value && std::is_signed<T>::value>> {
+    static inline PyObject *f(T value) {
+        if (sizeof(T) <= sizeof(long)) {
+            return PyLong_FromLong(static_cast<long>(value));
+        }
+        return PyLong_FromLongLong(static_cast<long long>(value));
+    }
+};
+
+template<typename T>
+struct to_python_converter<
+    T,
+    std::enable_if_t<std::is_integral<T>::value &&
+                     std::is_unsigned<T>::value>> {
+    static inline PyObject *f(T value) {
+        if (sizeof(T) <= sizeof(unsigned long)) {
+            return PyLong_FromUnsignedLong(static_cast<unsigned long>(value));
+        }
+        return PyLong_FromUnsignedLongLong(
+            static_cast<unsigned long long>(value));
+    }
+};
+
+template<typename T>
+struct to_python_converter<
+    T,
+    std::enable_if_t<std::is_floating_point<T>::value>> {
+    static inline PyObject *f(T value) {
+        return PyFloat_FromDouble(static_cast<double>(value));
+    }
+};
+
+/**
+   `std::string` is decoded as utf-8 without looking for the terminator.
+*/
+template<>
+struct to_python_converter<std::string> {
+    static inline PyObject *f(const std::string &value) {
+        return PyUnicode_FromStringAndSize(value.data(), value.size());
+    }
+};
+
+template<>
+struct to_python_converter<const char*> {
+    static inline PyObject *f(const char *value) {
+        return PyUnicode_FromString(value);
+    }
+};
+
+/**
+   Build a `tuple` of exactly `sizeof...(ns)` items, converting each
+   element of a tuple-like value.
+*/
+template<typename Tup, std::size_t... ns>
+inline PyObject *_to_python_tuple(Tup &&value, std::index_sequence<ns...>) {
+    // one extra slot so that the array is never empty
+    PyObject *items[] = {to_python(std::get<ns>(std::forward<Tup>(value)))...,
+                         nullptr};
+
+    PyObject *out = PyTuple_New(sizeof...(ns));
+    for (std::size_t n = 0; n < sizeof...(ns); ++n) {
+        if (!(out && items[n])) {
+            Py_CLEAR(out);
+            Py_XDECREF(items[n]);
+            continue;
+        }
+        PyTuple_SET_ITEM(out, n, items[n]);
+    }
+    return out;
+}
+
+/**
+   `std::pair` and `std::tuple` become a `tuple` which is allocated at
+   its final size.
+*/
+template<typename A, typename B>
+struct to_python_converter<std::pair<A, B>> {
+    template<typename P>
+    static inline PyObject *f(P &&value) {
+        return _to_python_tuple(std::forward<P>(value),
+                                std::make_index_sequence<2>{});
+    }
+};
+
+template<typename... Ts>
+struct to_python_converter<std::tuple<Ts...>> {
+    template<typename Tup>
+    static inline PyObject *f(Tup &&value) {
+        return _to_python_tuple(std::forward<Tup>(value),
+                                std::index_sequence_for<Ts...>{});
+    }
+};
+
+template<typename T>
+struct _is_owning_ref : std::false_type {};
+
+template<typename T>
+struct _is_owning_ref<py::tmpref<T>> : std::true_type {};
+
+template<typename T>
+struct _is_owning_ref<py::ownedref<T>> : std::true_type {};
+
+/**
+   Owning wrappers give their reference to the result when they are
+   rvalues, otherwise a new reference is made.
+*/
+template<typename T>
+struct to_python_converter<py::tmpref<T>> {
+    static inline PyObject *f(py::tmpref<T> &&value) {
+        PyObject *out = value;
+        std::move(value).invalidate();
+        return out;
+    }
+
+    static inline PyObject *f(const py::tmpref<T> &value) {
+        PyObject *out = value;
+        Py_XINCREF(out);
+        return out;
+    }
+};
+
+template<typename T>
+struct to_python_converter<py::ownedref<T>> {
+    static inline PyObject *f(py::ownedref<T> &&value) {
+        return to_python_converter<py::tmpref<T>>::f(
+            static_cast<py::tmpref<T>&&>(value));
+    }
+
+    static inline PyObject *f(const py::ownedref<T> &value) {
+        return to_python_converter<py::tmpref<T>>::f(value);
+    }
+};
+
+/**
+   Non-owning wrappers, like `py::object` or `py::list::object`, return a
+   new reference to the wrapped object. A wrapper around nullptr is
+   returned as nullptr so that a failure propagates.
+*/
+template<typename T>
+struct to_python_converter<
+    T,
+    std::enable_if_t<std::is_base_of<py::object, T>::value &&
+                     !_is_owning_ref<T>::value>> {
+    static inline PyObject *f(const T &value) {
+        PyObject *out = value;
+        Py_XINCREF(out);
+        return out;
+    }
+};
+}
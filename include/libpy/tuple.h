@@ -290,5 +290,20 @@ struct typeformat<py::tuple::object> {
     static inline auto make_arg(T &&t) {
         return std::make_tuple(&PyTuple_Type, std::forward<T>(t));
     }
+
+    static inline PyTypeObject *exact_type() {
+        return &PyTuple_Type;
+    }
+
+    static inline bool convert(PyObject *ob, py::tuple::object &out) {
+        if (!PyTuple_Check(ob)) {
+            PyErr_Format(PyExc_TypeError,
+                         "must be tuple, not %.50s",
+                         Py_TYPE(ob)->tp_name);
+            return false;
+        }
+        out = py::object(ob);
+        return true;
+    }
 };
 }
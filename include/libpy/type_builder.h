@@ -0,0 +1,362 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <Python.h>
+#include <structmember.h>
+
+#include "libpy/automethod.h"
+#include "libpy/object.h"
+#include "libpy/type.h"
+
+namespace py {
+namespace type {
+/**
+   The offset of the C++ value from the start of an instance of an
+   extension type created by `builder<T>`. The value is stored directly
+   after `PyObject_HEAD`.
+*/
+template<typename T>
+constexpr std::size_t value_offset() {
+    return (sizeof(PyObject) + alignof(T) - 1) / alignof(T) * alignof(T);
+}
+
+/**
+   Get the C++ value stored in an instance of an extension type created
+   by `builder<T>`.
+
+   @param ob An instance of the type.
+   @return   A reference to the value stored inline in `ob`.
+*/
+template<typename T>
+inline T &unbox(PyObject *ob) {
+    return *reinterpret_cast<T*>(reinterpret_cast<char*>(ob) +
+                                 value_offset<T>());
+}
+
+/**
+   Allocate an instance of a type created by `builder<T>` and construct
+   its value in place.
+
+   @param cls  The type, this must have been created by `builder<T>`.
+   @param args The arguments to the constructor of `T`.
+   @return     A new reference to the instance, or nullptr with a Python
+               exception set. Exceptions thrown by the constructor are
+               raised as a `RuntimeError`.
+*/
+template<typename T, typename... Args>
+PyObject *emplace(PyTypeObject *cls, Args&&... args) {
+    PyObject *self = cls->tp_alloc(cls, 0);
+    if (!self) {
+        return nullptr;
+    }
+
+    bool constructed = false;
+    try {
+        new(&unbox<T>(self)) T(std::forward<Args>(args)...);
+        constructed = true;
+    }
+    catch (const std::exception &e) {
+        PyErr_SetString(PyExc_RuntimeError, e.what());
+    }
+    catch (...) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "unknown error constructing object");
+    }
+    if (!constructed) {
+        // the value was never constructed so we cannot go through
+        // `tp_dealloc`
+        PyTypeObject *type = Py_TYPE(self);
+        type->tp_free(self);
+        Py_DECREF(type);
+        return nullptr;
+    }
+    return self;
+}
+
+template<typename M, typename = void>
+struct _member_type;
+
+#define _LIBPY_MEMBER_TYPE(ctype, code)         \
+    template<>                                  \
+    struct _member_type<ctype> {                \
+        static constexpr int value = code;      \
+    }
+
+_LIBPY_MEMBER_TYPE(bool, T_BOOL);
+_LIBPY_MEMBER_TYPE(char, T_CHAR);
+_LIBPY_MEMBER_TYPE(signed char, T_BYTE);
+_LIBPY_MEMBER_TYPE(unsigned char, T_UBYTE);
+_LIBPY_MEMBER_TYPE(short, T_SHORT);
+_LIBPY_MEMBER_TYPE(unsigned short, T_USHORT);
+_LIBPY_MEMBER_TYPE(int, T_INT);
+_LIBPY_MEMBER_TYPE(unsigned int, T_UINT);
+_LIBPY_MEMBER_TYPE(long, T_LONG);
+_LIBPY_MEMBER_TYPE(unsigned long, T_ULONG);
+_LIBPY_MEMBER_TYPE(long long, T_LONGLONG);
+_LIBPY_MEMBER_TYPE(unsigned long long, T_ULONGLONG);
+_LIBPY_MEMBER_TYPE(float, T_FLOAT);
+_LIBPY_MEMBER_TYPE(double, T_DOUBLE);
+
+#undef _LIBPY_MEMBER_TYPE
+
+/**
+   A data member of a `T` with type `M` at `offset` bytes from the start
+   of the `T`. Create these with `type_member(T, field)`.
+*/
+template<typename T, typename M>
+struct member_ref {
+    std::size_t offset;
+};
+
+/**
+   Builder for a Python extension type whose instances store a `T`
+   directly after `PyObject_HEAD`.
+
+   The type is created with `PyType_FromSpec`. Instances are constructed
+   with placement new in `tp_new` and destroyed in `tp_dealloc`, so there
+   is no separate allocation for the C++ object. Methods are added as
+   `PyMethodDef`s, usually from `automethod`, and receive the instance as
+   `self`; use `unbox<T>(self)` to get the value. Members are exposed
+   with `PyMemberDef` offsets into the instance so reading them does not
+   call any C++ code.
+
+   For example:
+
+   ```
+   py::type::builder<point>("mod.point")
+       .constructor<double, double>()
+       .method(automethod(norm))
+       .member("x", type_member(point, x))
+       .create();
+   ```
+
+   The name, method names, member names and docstrings must have static
+   storage duration, like the strings in a `PyMethodDef`.
+*/
+template<typename T>
+class builder {
+private:
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+                  "T is over aligned");
+
+    const char *name;
+    const char *doc;
+    std::vector<PyMethodDef> methods;
+    std::vector<PyMemberDef> members;
+    std::vector<PyType_Slot> extra_slots;
+    newfunc tp_new;
+
+    static void dealloc(PyObject *self) {
+        unbox<T>(self).~T();
+
+        PyTypeObject *type = Py_TYPE(self);
+        type->tp_free(self);
+        // instances of heap types own a reference to their type
+        Py_DECREF(type);
+    }
+
+    template<typename... Args, std::size_t... ns>
+    static PyObject *construct_impl(PyTypeObject *cls,
+                                    PyObject *args,
+                                    PyObject *kwargs,
+                                    std::index_sequence<ns...>) {
+        if (kwargs && PyDict_Size(kwargs)) {
+            PyErr_Format(PyExc_TypeError,
+                         "%s() takes no keyword arguments",
+                         cls->tp_name);
+            return nullptr;
+        }
+
+        Py_ssize_t nargs = PyTuple_GET_SIZE(args);
+        if (nargs != sizeof...(Args)) {
+            PyErr_Format(PyExc_TypeError,
+                         "%s() takes exactly %zu argument%s (%zd given)",
+                         cls->tp_name,
+                         sizeof...(Args),
+                         sizeof...(Args) == 1 ? "" : "s",
+                         nargs);
+            return nullptr;
+        }
+
+        std::tuple<Args...> parsed_args;
+        bool ok = true;
+        (void) std::initializer_list<bool>{
+            (ok = ok && pyutils::convert_argument(
+                PyTuple_GET_ITEM(args, ns),
+                std::get<ns>(parsed_args)))...};
+        if (!ok) {
+            return nullptr;
+        }
+        return emplace<T>(cls, std::move(std::get<ns>(parsed_args))...);
+    }
+
+    template<typename... Args>
+    static PyObject *construct(PyTypeObject *cls,
+                               PyObject *args,
+                               PyObject *kwargs) {
+        return construct_impl<Args...>(cls,
+                                       args,
+                                       kwargs,
+                                       std::index_sequence_for<Args...>{});
+    }
+
+    /**
+       `tp_new` for types without a constructor. Without this the type
+       would inherit `object.__new__` which does not construct the value.
+    */
+    static PyObject *not_constructible(PyTypeObject *cls,
+                                       PyObject*,
+                                       PyObject*) {
+        PyErr_Format(PyExc_TypeError,
+                     "cannot create '%.100s' instances",
+                     cls->tp_name);
+        return nullptr;
+    }
+
+    static newfunc default_new(std::true_type) {
+        return construct<>;
+    }
+
+    static newfunc default_new(std::false_type) {
+        return not_constructible;
+    }
+
+    /**
+       Copy a null terminated array to the heap. The type keeps pointers
+       to its methods and members so these are never freed, types are
+       expected to live as long as the interpreter.
+    */
+    template<typename D>
+    static D *leak_array(const std::vector<D> &defs) {
+        D *out = new D[defs.size() + 1];
+        std::copy(defs.begin(), defs.end(), out);
+        std::memset(&out[defs.size()], 0, sizeof(D));
+        return out;
+    }
+
+public:
+    /**
+       @param name The name of the type, including the module, for
+                   example: `"mod.point"`.
+       @param doc  The docstring for the type.
+    */
+    builder(const char *name, const char *doc = nullptr)
+        : name(name),
+          doc(doc),
+          tp_new(default_new(std::is_default_constructible<T>{})) {}
+
+    /**
+       Construct instances from Python with the constructor of `T` which
+       takes `Args...`. Each argument is converted with `typeformat`.
+       By default instances are default constructed if `T` is default
+       constructible, otherwise the type cannot be instantiated from
+       Python.
+    */
+    template<typename... Args>
+    builder &constructor() {
+        tp_new = construct<Args...>;
+        return *this;
+    }
+
+    /**
+       Add a method to the type.
+
+       @param def The method definition, usually from `automethod`.
+    */
+    builder &method(const PyMethodDef &def) {
+        methods.push_back(def);
+        return *this;
+    }
+
+    /**
+       Set a type slot which is not otherwise managed by the builder, for
+       example `Py_tp_iternext` or `Py_nb_add`.
+
+       @param slot  The slot id from `typeslots.h`.
+       @param pfunc The value of the slot.
+    */
+    builder &slot(int slot, void *pfunc) {
+        extra_slots.push_back({slot, pfunc});
+        return *this;
+    }
+
+    /**
+       Expose a data member of `T` as an attribute.
+
+       @param name     The name of the attribute.
+       Only members with a primitive C type are supported. Object
+       members would need `tp_traverse` and a decref in `tp_dealloc`
+       which the builder does not provide.
+
+       @param name     The name of the attribute.
+       @param member   The member of `T`, from `type_member(T, field)`.
+       @param readonly Should assignment to the attribute be disallowed?
+       @param doc      The docstring for the attribute.
+    */
+    template<typename M>
+    builder &member(const char *name,
+                    member_ref<T, M> member,
+                    bool readonly = false,
+                    const char *doc = nullptr) {
+        static_assert(std::is_standard_layout<T>::value,
+                      "members can only be exposed for standard layout types");
+        static_assert(!std::is_pointer<M>::value,
+                      "pointer members cannot be exposed, object members"
+                      " would need gc support");
+        members.push_back({const_cast<char*>(name),
+                           _member_type<M>::value,
+                           static_cast<Py_ssize_t>(value_offset<T>() +
+                                                   member.offset),
+                           readonly ? READONLY : 0,
+                           const_cast<char*>(doc)});
+        return *this;
+    }
+
+    /**
+       Create the type.
+
+       @return The new type, or nullptr with a Python exception set.
+    */
+    tmpref<type::object<>> create() const {
+        std::vector<PyType_Slot> slots = {
+            {Py_tp_dealloc, reinterpret_cast<void*>(dealloc)},
+            {Py_tp_methods, leak_array(methods)},
+            {Py_tp_members, leak_array(members)},
+        };
+        slots.push_back({Py_tp_new, reinterpret_cast<void*>(tp_new)});
+        if (doc) {
+            slots.push_back({Py_tp_doc, const_cast<char*>(doc)});
+        }
+        slots.insert(slots.end(), extra_slots.begin(), extra_slots.end());
+        slots.push_back({0, nullptr});
+
+        PyType_Spec spec = {
+            name,
+            static_cast<int>(value_offset<T>() + sizeof(T)),
+            0,
+            Py_TPFLAGS_DEFAULT,
+            slots.data(),
+        };
+        return PyType_FromSpec(&spec);
+    }
+};
+}
+}
+
+/**
+   Refer to a data member of `T` for `py::type::builder<T>::member`. The
+   offset is computed with `offsetof` so `T` must be standard layout.
+
+   @param T     The type which holds the member.
+   @param field The name of the member.
+*/
+#define type_member(T, field)                                           \
+    ::py::type::member_ref<T, decltype(T::field)>{offsetof(T, field)}
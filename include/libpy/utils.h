@@ -1,6 +1,8 @@
 #pragma once
 #include <exception>
+#include <iterator>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 
 #include <Python.h>
@@ -45,8 +47,74 @@ auto tuple_refs(T &&t) {
         >::value>{});
 }
 
+/**
+   Check if `It` is at least a forward iterator, so that its length may
+   be taken with `std::distance` without consuming it.
+*/
+template<typename It>
+using _is_forward_iterator = std::is_base_of<
+    std::forward_iterator_tag,
+    typename std::iterator_traits<It>::iterator_category>;
+
+/**
+   The argument type of a callable which takes one argument.
+*/
+template<typename F, typename = void>
+struct _unary_argument;
+
+template<typename R, typename A>
+struct _unary_argument<R(*)(A)> {
+    using type = std::decay_t<A>;
+};
+
+template<typename R, typename C, typename A>
+struct _unary_argument<R(C::*)(A) const> {
+    using type = std::decay_t<A>;
+};
+
+template<typename R, typename C, typename A>
+struct _unary_argument<R(C::*)(A)> {
+    using type = std::decay_t<A>;
+};
+
+template<typename F>
+struct _unary_argument<F, std::enable_if_t<std::is_class<F>::value>>
+    : public _unary_argument<decltype(&F::operator())> {};
+
 class bad_nonnull : public std::exception {};
 
+/**
+   Set aside an exception which is pending before an operation that
+   reports failure through `PyErr_Occurred()`, such as iterating a
+   `py::object`. The set aside exception is restored when the operation
+   did not raise and dropped when it did.
+*/
+class _pending_error {
+private:
+    PyObject *type;
+    PyObject *value;
+    PyObject *traceback;
+
+public:
+    _pending_error() {
+        PyErr_Fetch(&type, &value, &traceback);
+    }
+
+    _pending_error(const _pending_error&) = delete;
+    _pending_error &operator=(const _pending_error&) = delete;
+
+    ~_pending_error() {
+        if (PyErr_Occurred()) {
+            Py_XDECREF(type);
+            Py_XDECREF(value);
+            Py_XDECREF(traceback);
+        }
+        else {
+            PyErr_Restore(type, value, traceback);
+        }
+    }
+};
+
 /**
    This function properly propagates CPython exceptions or raises
    an `AssertionError` if a null check is failed.
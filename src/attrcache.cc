@@ -0,0 +1,143 @@
+#include <Python.h>
+#include <structmember.h>
+
+#include "libpy/attrcache.h"
+
+py::attrcache::attrcache(const py::object &name)
+    : name(name),
+      type(nullptr),
+      version_tag(0),
+      cached(kind::none),
+      descr(nullptr),
+      descr_get(nullptr),
+      member(nullptr) {
+    Py_XINCREF(this->name);
+}
+
+PyObject *py::attrcache::from_dict(PyObject *ob) const {
+#ifdef Py_TPFLAGS_MANAGED_DICT
+    if (PyType_HasFeature(Py_TYPE(ob), Py_TPFLAGS_MANAGED_DICT)) {
+        // `_PyObject_GetDictPtr` also creates a managed dict but it
+        // swallows the error if that fails
+        PyObject *dict = PyObject_GenericGetDict(ob, nullptr);
+        if (!dict) {
+            return nullptr;
+        }
+        PyObject *value = PyDict_GetItemWithError(dict, name);
+        Py_XINCREF(value);
+        Py_DECREF(dict);
+        return value;
+    }
+#endif
+    PyObject **dictptr = _PyObject_GetDictPtr(ob);
+    if (!(dictptr && *dictptr)) {
+        return nullptr;
+    }
+
+    PyObject *value = PyDict_GetItemWithError(*dictptr, name);
+    Py_XINCREF(value);
+    return value;
+}
+
+PyObject *py::attrcache::lookup(PyObject *ob) const {
+    switch (cached) {
+    case kind::member:
+        if (member->type == T_OBJECT_EX) {
+            // the slot is empty, use the generic lookup to raise the
+            // AttributeError
+            return PyObject_GetAttr(ob, name);
+        }
+        return PyMember_GetOne(reinterpret_cast<const char*>(ob), member);
+    case kind::data_descr: {
+        // copy the cache entry and hold a reference to the descriptor
+        // because the getter may run arbitrary code which modifies the
+        // type or refreshes this cache
+        PyObject *d = descr;
+        PyObject *tp = reinterpret_cast<PyObject*>(type);
+        Py_INCREF(d);
+        PyObject *value = descr_get(d, ob, tp);
+        Py_DECREF(d);
+        return value;
+    }
+    case kind::type_attr: {
+        PyObject *d = descr;
+        descrgetfunc get = descr_get;
+        PyObject *tp = reinterpret_cast<PyObject*>(type);
+        Py_INCREF(d);
+
+        PyObject *value = from_dict(ob);
+        if (value || PyErr_Occurred()) {
+            Py_DECREF(d);
+            return value;
+        }
+        if (!get) {
+            return d;
+        }
+        value = get(d, ob, tp);
+        Py_DECREF(d);
+        return value;
+    }
+    case kind::instance_attr: {
+        PyObject *value = from_dict(ob);
+        if (value || PyErr_Occurred()) {
+            return value;
+        }
+        return PyObject_GetAttr(ob, name);
+    }
+    case kind::none:
+    default:
+        return PyObject_GetAttr(ob, name);
+    }
+}
+
+PyObject *py::attrcache::refresh(PyObject *ob) {
+    PyTypeObject *tp = Py_TYPE(ob);
+
+    cached = kind::none;
+    type = nullptr;
+
+    // only the generic lookup can be specialized, types with custom
+    // __getattribute__ or __getattr__ may do anything
+    if (!name || tp->tp_getattro != PyObject_GenericGetAttr ||
+        !PyUnicode_CheckExact(name)) {
+        return lookup(ob);
+    }
+
+    // looking up the attribute assigns a version tag to the type if it
+    // does not already have one
+    PyObject *d = _PyType_Lookup(tp, name);
+    if (!PyType_HasFeature(tp, Py_TPFLAGS_VALID_VERSION_TAG)) {
+        return lookup(ob);
+    }
+
+    type = tp;
+    version_tag = tp->tp_version_tag;
+    descr = d;
+    descr_get = nullptr;
+    member = nullptr;
+
+    if (!d) {
+        cached = kind::instance_attr;
+    }
+    else if (Py_TYPE(d)->tp_descr_get && Py_TYPE(d)->tp_descr_set) {
+        PyMemberDef *m = nullptr;
+        if (Py_TYPE(d) == &PyMemberDescr_Type) {
+            m = reinterpret_cast<PyMemberDescrObject*>(d)->d_member;
+        }
+
+        if (m && !(m->flags & READ_RESTRICTED)) {
+            member = m;
+            cached = kind::member;
+        }
+        else {
+            descr_get = Py_TYPE(d)->tp_descr_get;
+            cached = kind::data_descr;
+        }
+    }
+    else {
+        descr_get = Py_TYPE(d)->tp_descr_get;
+        cached = kind::type_attr;
+    }
+
+    return lookup(ob);
+}
@@ -0,0 +1,139 @@
+#include <atomic>
+#include <map>
+#include <string>
+
+#include <Python.h>
+
+#include "libpy/automethod_stats.h"
+#include "libpy/object.h"
+
+namespace {
+std::atomic<pyutils::automethod_stats_slot*> registered_slots{nullptr};
+
+/**
+   A snapshot of an `automethod_histogram`, summed over every slot with
+   the same name.
+*/
+struct histogram_totals {
+    std::uint64_t total_ns = 0;
+    std::uint64_t buckets[pyutils::automethod_histogram::nbuckets] = {};
+
+    void add(const pyutils::automethod_histogram &histogram) {
+        total_ns += histogram.total_ns.load(std::memory_order_relaxed);
+        for (std::size_t n = 0;
+             n < pyutils::automethod_histogram::nbuckets;
+             ++n) {
+            buckets[n] += histogram.buckets[n].load(std::memory_order_relaxed);
+        }
+    }
+};
+
+struct slot_totals {
+    std::uint64_t calls = 0;
+    std::uint64_t errors = 0;
+    histogram_totals parse;
+    histogram_totals body;
+    histogram_totals convert;
+
+    void add(const pyutils::automethod_stats_slot &slot) {
+        calls += slot.calls.load(std::memory_order_relaxed);
+        errors += slot.errors.load(std::memory_order_relaxed);
+        parse.add(slot.parse);
+        body.add(slot.body);
+        convert.add(slot.convert);
+    }
+};
+
+PyObject *histogram_dict(const histogram_totals &histogram) {
+    std::size_t nbuckets = 0;
+    for (std::size_t n = 0; n < pyutils::automethod_histogram::nbuckets; ++n) {
+        if (histogram.buckets[n]) {
+            nbuckets = n + 1;
+        }
+    }
+
+    py::tmpref<py::object> buckets(PyList_New(nbuckets));
+    if (!buckets.is_nonnull()) {
+        return nullptr;
+    }
+    for (std::size_t n = 0; n < nbuckets; ++n) {
+        PyObject *count = PyLong_FromUnsignedLongLong(histogram.buckets[n]);
+        if (!count) {
+            return nullptr;
+        }
+        PyList_SET_ITEM(static_cast<PyObject*>(buckets), n, count);
+    }
+
+    return Py_BuildValue(
+        "{sKsO}",
+        "total_ns",
+        static_cast<unsigned long long>(histogram.total_ns),
+        "histogram",
+        static_cast<PyObject*>(buckets));
+}
+
+PyObject *slot_dict(const slot_totals &slot) {
+    py::tmpref<py::object> parse(histogram_dict(slot.parse));
+    if (!parse.is_nonnull()) {
+        return nullptr;
+    }
+    py::tmpref<py::object> body(histogram_dict(slot.body));
+    if (!body.is_nonnull()) {
+        return nullptr;
+    }
+    py::tmpref<py::object> convert(histogram_dict(slot.convert));
+    if (!convert.is_nonnull()) {
+        return nullptr;
+    }
+
+    return Py_BuildValue(
+        "{sKsKsOsOsO}",
+        "calls",
+        static_cast<unsigned long long>(slot.calls),
+        "errors",
+        static_cast<unsigned long long>(slot.errors),
+        "parse",
+        static_cast<PyObject*>(parse),
+        "body",
+        static_cast<PyObject*>(body),
+        "convert",
+        static_cast<PyObject*>(convert));
+}
+}
+
+void pyutils::_register_automethod_stats(automethod_stats_slot *slot) {
+    slot->next = registered_slots.load(std::memory_order_relaxed);
+    while (!registered_slots.compare_exchange_weak(slot->next,
+                                                   slot,
+                                                   std::memory_order_release,
+                                                   std::memory_order_relaxed)) {
+    }
+}
+
+PyObject *pyutils::automethod_stats(PyObject*) {
+    // functions with the same name, like `__len__` on two types, are
+    // reported together
+    std::map<std::string, slot_totals> totals;
+    for (const automethod_stats_slot *slot =
+             registered_slots.load(std::memory_order_acquire);
+         slot;
+         slot = slot->next) {
+        totals[slot->name].add(*slot);
+    }
+
+    py::tmpref<py::object> out(PyDict_New());
+    if (!out.is_nonnull()) {
+        return nullptr;
+    }
+    for (const auto &item : totals) {
+        py::tmpref<py::object> entry(slot_dict(item.second));
+        if (!entry.is_nonnull() ||
+            PyDict_SetItemString(out, item.first.c_str(), entry)) {
+            return nullptr;
+        }
+    }
+
+    PyObject *result = out;
+    std::move(out).invalidate();
+    return result;
+}
@@ -0,0 +1,142 @@
+#include "libpy/dict.h"
+#include "libpy/utils.h"
+
+namespace d = py::dict;
+
+const py::type::object<d::object>
+d::type(reinterpret_cast<PyObject*>(&PyDict_Type));
+
+d::object::object() : py::object() {}
+
+d::object::object(PyObject *pob) : py::object(pob) {
+    dict_check();
+}
+
+d::object::object(const py::object &pob) : py::object(pob) {
+    dict_check();
+}
+
+d::object::object(const d::object &cpfrom) : py::object(cpfrom.ob) {}
+
+d::object::object(d::object &&mvfrom) noexcept : py::object(mvfrom.ob) {
+    mvfrom.ob = nullptr;
+}
+
+void d::object::dict_check() {
+    if (ob && !PyDict_Check(ob)) {
+        ob = nullptr;
+        if (!PyErr_Occurred()) {
+            PyErr_SetString(PyExc_TypeError,
+                            "cannot make py::dict::object from non dict");
+        }
+    }
+}
+
+d::object::const_iterator d::object::cbegin() const {
+    return const_iterator(ob);
+}
+
+d::object::const_iterator d::object::cend() const {
+    return const_iterator();
+}
+
+d::object::iterator d::object::begin() const {
+    return cbegin();
+}
+
+d::object::iterator d::object::end() const {
+    return cend();
+}
+
+py::ssize_t d::object::len() const {
+    if (!is_nonnull()) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    return PyDict_Size(ob);
+}
+
+py::object d::object::get(const py::object &key) const {
+    if (!pyutils::all_nonnull(*this, key)) {
+        pyutils::failed_null_check();
+        return nullptr;
+    }
+    return PyDict_GetItemWithError(ob, key);
+}
+
+py::object d::object::get(const py::object &key, py::hash_t hash) const {
+    if (!pyutils::all_nonnull(*this, key)) {
+        pyutils::failed_null_check();
+        return nullptr;
+    }
+#if HAVE_DICT_KNOWN_HASH
+    return _PyDict_GetItem_KnownHash(ob, key, hash);
+#else
+    static_cast<void>(hash);
+    return PyDict_GetItemWithError(ob, key);
+#endif
+}
+
+int d::object::contains(const py::object &key) const {
+    if (!pyutils::all_nonnull(*this, key)) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    return PyDict_Contains(ob, key);
+}
+
+int d::object::contains(const py::object &key, py::hash_t hash) const {
+    if (get(key, hash).is_nonnull()) {
+        return 1;
+    }
+    return PyErr_Occurred() ? -1 : 0;
+}
+
+int d::object::setitem(const py::object &key,
+                       const py::object &value) const {
+    if (!pyutils::all_nonnull(*this, key, value)) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    return PyDict_SetItem(ob, key, value);
+}
+
+int d::object::setitem(const py::object &key,
+                       py::hash_t hash,
+                       const py::object &value) const {
+    if (!pyutils::all_nonnull(*this, key, value)) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+#if HAVE_DICT_KNOWN_HASH
+    return _PyDict_SetItem_KnownHash(ob, key, value, hash);
+#else
+    static_cast<void>(hash);
+    return PyDict_SetItem(ob, key, value);
+#endif
+}
+
+int d::object::delitem(const py::object &key) const {
+    if (!pyutils::all_nonnull(*this, key)) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    return PyDict_DelItem(ob, key);
+}
+
+py::nonnull<d::object> d::object::as_nonnull() const {
+    if (!is_nonnull()) {
+        throw pyutils::bad_nonnull();
+    }
+    return nonnull<d::object>(ob);
+}
+
+py::tmpref<d::object> d::object::as_tmpref() && {
+    tmpref<d::object> ret(ob);
+    ob = nullptr;
+    return ret;
+}
+
+py::tmpref<d::object> d::presized(py::ssize_t n) {
+    return _PyDict_NewPresized(n);
+}
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <cstring>
+
 #include "libpy/list.h"
 #include "libpy/utils.h"
 
@@ -98,6 +101,144 @@ py::object l::object::operator[](std::size_t idx) const {
 }
 
 
+namespace {
+/**
+   Reallocate the storage of a list to hold exactly `allocated`
+   elements. `allocated` must not be less than the length of the list.
+*/
+int resize_storage(PyObject *ob, py::ssize_t allocated) {
+    PyListObject *list = reinterpret_cast<PyListObject*>(ob);
+    if (static_cast<std::size_t>(allocated) >
+        PY_SSIZE_T_MAX / sizeof(PyObject*)) {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    PyObject **items = nullptr;
+    if (allocated) {
+        items = static_cast<PyObject**>(
+            PyMem_Realloc(list->ob_item, allocated * sizeof(PyObject*)));
+        if (!items) {
+            PyErr_NoMemory();
+            return -1;
+        }
+    }
+    else {
+        PyMem_Free(list->ob_item);
+    }
+    list->ob_item = items;
+    list->allocated = allocated;
+    return 0;
+}
+}
+
+py::ssize_t l::object::capacity() const {
+    if (!is_nonnull()) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    return reinterpret_cast<PyListObject*>(ob)->allocated;
+}
+
+int l::object::reserve(py::ssize_t n) const {
+    if (!is_nonnull()) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    if (n <= reinterpret_cast<PyListObject*>(ob)->allocated) {
+        return 0;
+    }
+    return resize_storage(ob, n);
+}
+
+int l::object::shrink_to_fit() const {
+    if (!is_nonnull()) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    if (reinterpret_cast<PyListObject*>(ob)->allocated == Py_SIZE(ob)) {
+        return 0;
+    }
+    return resize_storage(ob, Py_SIZE(ob));
+}
+
+int l::object::extend_sequence(PyObject *other) const {
+    py::ssize_t n = Py_SIZE(other);
+    py::ssize_t size = Py_SIZE(ob);
+    if (n > PY_SSIZE_T_MAX - size) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    if (reserve(size + n)) {
+        return -1;
+    }
+
+    // read the source storage after reserving because `other` may be
+    // this list
+    PyObject **src = PyList_CheckExact(other) ?
+        reinterpret_cast<PyListObject*>(other)->ob_item :
+        reinterpret_cast<PyTupleObject*>(other)->ob_item;
+    PyObject **dest = reinterpret_cast<PyListObject*>(ob)->ob_item + size;
+    if (n) {
+        std::memcpy(dest, src, n * sizeof(PyObject*));
+    }
+    for (py::ssize_t ix = 0; ix < n; ++ix) {
+        Py_INCREF(dest[ix]);
+    }
+    Py_SET_SIZE(ob, size + n);
+    return 0;
+}
+
+int l::object::extend_iterable(PyObject *other) const {
+    pyutils::_pending_error pending;
+    PyObject *it = PyObject_GetIter(other);
+    if (!it) {
+        return -1;
+    }
+
+    py::ssize_t hint = PyObject_LengthHint(other, 0);
+    if (hint < 0 ||
+        reserve(Py_SIZE(ob) +
+                std::min(hint, PY_SSIZE_T_MAX - Py_SIZE(ob)))) {
+        Py_DECREF(it);
+        return -1;
+    }
+
+    PyObject *item;
+    while ((item = PyIter_Next(it))) {
+        if (reinterpret_cast<PyListObject*>(ob)->allocated > Py_SIZE(ob)) {
+            append_reserved(item);
+        }
+        else {
+            int err = PyList_Append(ob, item);
+            Py_DECREF(item);
+            if (err) {
+                Py_DECREF(it);
+                return -1;
+            }
+        }
+    }
+    // `PyIter_Next` returns nullptr at the end and on error, check before
+    // releasing the iterator can run other code
+    bool failed = PyErr_Occurred();
+    Py_DECREF(it);
+    return failed ? -1 : 0;
+}
+
+int l::object::extend(const py::object &other) const {
+    if (!pyutils::all_nonnull(*this, other)) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    PyObject *pother = other;
+    // subclasses may override `__iter__` so only exact lists and tuples
+    // are copied directly, like `list.extend`
+    if (PyList_CheckExact(pother) || PyTuple_CheckExact(pother)) {
+        return extend_sequence(pother);
+    }
+    return extend_iterable(pother);
+}
+
 py::nonnull<l::object> l::object::as_nonnull() const {
     if (!is_nonnull()) {
         throw pyutils::bad_nonnull();
@@ -2,6 +2,7 @@
 #include <utility>
 
 #include "libpy/object.h"
+#include "libpy/str.h"
 
 const py::object py::None = Py_None;
 const py::object py::NotImplemented = Py_NotImplemented;
@@ -68,10 +69,77 @@ const py::object &py::operator""_p(long double d) {
     return ob;
 }
 
+PyObject *py::_vectorcall_fallback(PyObject *f,
+                                   PyObject *const *args,
+                                   std::size_t nargs,
+                                   PyObject *kwnames) {
+    py::tmpref<py::object> pyargs(PyTuple_New(nargs));
+    if (!pyargs.is_nonnull()) {
+        return nullptr;
+    }
+    for (std::size_t n = 0; n < nargs; ++n) {
+        Py_INCREF(args[n]);
+        PyTuple_SET_ITEM(static_cast<PyObject*>(pyargs), n, args[n]);
+    }
+
+    if (!kwnames || !PyTuple_GET_SIZE(kwnames)) {
+        return PyObject_Call(f, pyargs, nullptr);
+    }
+
+    py::tmpref<py::object> kwargs(PyDict_New());
+    if (!kwargs.is_nonnull()) {
+        return nullptr;
+    }
+    for (py::ssize_t n = 0; n < PyTuple_GET_SIZE(kwnames); ++n) {
+        if (PyDict_SetItem(kwargs,
+                           PyTuple_GET_ITEM(kwnames, n),
+                           args[nargs + n])) {
+            return nullptr;
+        }
+    }
+    return PyObject_Call(f, pyargs, kwargs);
+}
+
+#if PY_VERSION_HEX >= 0x03070000 && PY_VERSION_HEX < 0x03090000
+// exported since 3.7 to implement LOAD_METHOD but not declared in the headers
+extern "C" int _PyObject_GetMethod(PyObject*, PyObject*, PyObject**);
+#endif
+
+PyObject *py::_vectorcall_method_fallback(PyObject *name,
+                                          PyObject *const *args,
+                                          std::size_t nargs,
+                                          PyObject *kwnames) {
+#if PY_VERSION_HEX >= 0x03070000
+    PyObject *method = nullptr;
+    int unbound = _PyObject_GetMethod(args[0], name, &method);
+    if (!method) {
+        return nullptr;
+    }
+
+    PyObject *result = unbound ?
+        py::vectorcall(method, args, nargs, kwnames) :
+        py::vectorcall(method, args + 1, nargs - 1, kwnames);
+    Py_DECREF(method);
+    return result;
+#else
+    py::tmpref<py::object> method(PyObject_GetAttr(args[0], name));
+    if (!method.is_nonnull()) {
+        return nullptr;
+    }
+    return py::vectorcall(method, args + 1, nargs - 1, kwnames);
+#endif
+}
+
 std::ostream &py::operator<<(std::ostream &stream, const py::object &ob) {
-    /* We can avoid the null check because this happens in PyUnicode_AsUTF8.
-       When ob is nullptr the result is "<NULL>". */
-    return stream << PyUnicode_AsUTF8(ob.str());
+    /* When ob is nullptr the str is "<NULL>". The view carries the length
+       so the text is written without a strlen and may contain NULs. */
+    tmpref<py::object> text = ob.str();
+    py::str::string_view view = py::str::object(text).utf8();
+    if (!view.data()) {
+        stream.setstate(std::ios_base::badbit);
+        return stream;
+    }
+    return stream.write(view.data(), view.size());
 }
 
 py::object &py::object::operator=(const py::object &cpfrom) {
@@ -157,6 +225,39 @@ py::tmpref<py::object> py::object::next() const {
     return PyIter_Next(ob);
 }
 
+py::ssize_t py::object::next_batch(PyObject **buffer, py::ssize_t n) const {
+    if (!is_nonnull()) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    if (!PyIter_Check(ob)) {
+        PyErr_Format(PyExc_TypeError,
+                     "'%.200s' object is not an iterator",
+                     Py_TYPE(ob)->tp_name);
+        return -1;
+    }
+
+    iternextfunc iternext = Py_TYPE(ob)->tp_iternext;
+    py::ssize_t taken = 0;
+    while (taken < n) {
+        PyObject *item = iternext(ob);
+        if (!item) {
+            if (PyErr_Occurred()) {
+                if (!PyErr_ExceptionMatches(PyExc_StopIteration)) {
+                    for (py::ssize_t ix = 0; ix < taken; ++ix) {
+                        Py_DECREF(buffer[ix]);
+                    }
+                    return -1;
+                }
+                PyErr_Clear();
+            }
+            break;
+        }
+        buffer[taken++] = item;
+    }
+    return taken;
+}
+
 py::object::iterator py::object::begin() const {
     return cbegin();
 }
@@ -166,7 +267,7 @@ py::object::iterator py::object::end() const {
 }
 
 py::object::const_iterator py::object::cbegin() const {
-    return py::object(ob_unary_func<PyObject_GetIter>());
+    return py::object::const_iterator(*this);
 }
 
 py::object::const_iterator py::object::cend() const {
@@ -231,6 +332,15 @@ const py::object &py::object::incref() const {
 
 const py::object &py::object::decref() {
     if (is_nonnull()) {
+#if PY_VERSION_HEX >= 0x03080000
+        // Py_DECREF is an inline function which does not expose the
+        // reference total macros used below
+        bool last = Py_REFCNT(ob) == 1;
+        Py_DECREF(ob);
+        if (last) {
+            ob = nullptr;
+        }
+#else
         // reimplement the Py_DECREF macro here so that we can set ob = nullptr
         // when we dealloc without checking the refcount twice
         if (_Py_DEC_REFTOTAL  _Py_REF_DEBUG_COMMA --(ob)->ob_refcnt != 0) {
@@ -239,6 +349,7 @@ const py::object &py::object::decref() {
             _Py_Dealloc(ob);
             ob = nullptr;
         }
+#endif
     }
     return *this;
 }
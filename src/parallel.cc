@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "libpy/parallel.h"
+
+namespace {
+/**
+   True on the pool's worker threads and on a thread which is currently
+   running a job.
+*/
+thread_local bool in_pool = false;
+
+/**
+   A fixed set of worker threads which all help with one job at a time.
+
+   The pool is created on first use and never destroyed; the workers are
+   blocked on the condition variable when the process exits.
+*/
+class pool {
+private:
+    struct job {
+        const std::function<void(std::size_t, std::size_t)> *body;
+        std::size_t n;
+        std::size_t chunk;
+        std::size_t nworkers;
+        std::atomic<std::size_t> next{0};
+        std::mutex error_mutex;
+        std::exception_ptr error;
+    };
+
+    std::vector<std::thread> workers;
+
+    /**
+       Serializes callers so that there is one job at a time.
+    */
+    std::mutex submit_mutex;
+
+    std::mutex mutex;
+    std::condition_variable work_ready;
+    std::condition_variable work_done;
+    job *current = nullptr;
+    std::size_t generation = 0;
+
+    /**
+       The number of workers which are running blocks of `current`. The
+       job lives on the submitting thread's stack so it may not return
+       until this is 0.
+    */
+    std::size_t active = 0;
+
+    /**
+       Run blocks of `j` until there are none left.
+    */
+    static void run(job &j) {
+        while (true) {
+            std::size_t begin = j.next.fetch_add(j.chunk);
+            if (begin >= j.n) {
+                return;
+            }
+            std::size_t end = std::min(begin + j.chunk, j.n);
+            try {
+                (*j.body)(begin, end);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(j.error_mutex);
+                if (!j.error) {
+                    j.error = std::current_exception();
+                }
+            }
+        }
+    }
+
+    void worker(std::size_t index) {
+        in_pool = true;
+        std::size_t seen = 0;
+        while (true) {
+            job *j;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                work_ready.wait(lock, [&] { return generation != seen; });
+                seen = generation;
+                j = current;
+                if (!j || index >= j->nworkers) {
+                    continue;
+                }
+                ++active;
+            }
+            run(*j);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                --active;
+            }
+            work_done.notify_all();
+        }
+    }
+
+public:
+    /**
+       The number of threads, including the submitting thread, which run
+       each job.
+    */
+    std::atomic<std::size_t> nthreads;
+
+    explicit pool(std::size_t nthreads) : nthreads(nthreads) {}
+
+    std::exception_ptr
+    submit(std::size_t n,
+           std::size_t chunk,
+           const std::function<void(std::size_t, std::size_t)> &body) {
+        std::lock_guard<std::mutex> submitting(submit_mutex);
+
+        job j;
+        j.body = &body;
+        j.n = n;
+        j.chunk = chunk;
+        j.nworkers = nthreads - 1;
+        // workers are started on demand and never stopped, extra workers
+        // skip the job
+        while (workers.size() < j.nworkers) {
+            workers.emplace_back(&pool::worker, this, workers.size());
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            current = &j;
+            ++generation;
+        }
+        work_ready.notify_all();
+
+        in_pool = true;
+        run(j);
+        in_pool = false;
+
+        // every block has been claimed, wait for the workers to finish
+        // theirs
+        std::unique_lock<std::mutex> lock(mutex);
+        current = nullptr;
+        work_done.wait(lock, [&] { return !active; });
+        return j.error;
+    }
+};
+
+pool &shared_pool() {
+    static pool *instance = new pool(
+        std::max(std::thread::hardware_concurrency(), 1u));
+    return *instance;
+}
+}
+
+std::size_t pyutils::parallel_threads() {
+    return shared_pool().nthreads;
+}
+
+void pyutils::set_parallel_threads(std::size_t n) {
+    shared_pool().nthreads = std::max<std::size_t>(n, 1);
+}
+
+std::exception_ptr
+pyutils::_parallel_for(std::size_t n,
+                       std::size_t chunk,
+                       const std::function<void(std::size_t,
+                                                std::size_t)> &body) {
+    if (!n) {
+        return nullptr;
+    }
+
+    if (!chunk) {
+        // a few blocks per thread to balance uneven work
+        chunk = std::max<std::size_t>(n / (parallel_threads() * 4), 1);
+    }
+
+    if (in_pool || chunk >= n || parallel_threads() == 1) {
+        try {
+            body(0, n);
+        }
+        catch (...) {
+            return std::current_exception();
+        }
+        return nullptr;
+    }
+    return shared_pool().submit(n, chunk, body);
+}
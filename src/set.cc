@@ -0,0 +1,149 @@
+#include "libpy/set.h"
+#include "libpy/utils.h"
+
+namespace s = py::set;
+
+const py::type::object<s::object>
+s::type(reinterpret_cast<PyObject*>(&PySet_Type));
+
+const py::type::object<s::object>
+s::frozenset_type(reinterpret_cast<PyObject*>(&PyFrozenSet_Type));
+
+s::object::object() : py::object() {}
+
+s::object::object(PyObject *pob) : py::object(pob) {
+    set_check();
+}
+
+s::object::object(const py::object &pob) : py::object(pob) {
+    set_check();
+}
+
+s::object::object(const s::object &cpfrom) : py::object(cpfrom.ob) {}
+
+s::object::object(s::object &&mvfrom) noexcept : py::object(mvfrom.ob) {
+    mvfrom.ob = nullptr;
+}
+
+void s::object::set_check() {
+    if (ob && !PyAnySet_Check(ob)) {
+        ob = nullptr;
+        if (!PyErr_Occurred()) {
+            PyErr_SetString(PyExc_TypeError,
+                            "cannot make py::set::object from non set");
+        }
+    }
+}
+
+py::ssize_t s::object::len() const {
+    if (!is_nonnull()) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    return PySet_GET_SIZE(ob);
+}
+
+int s::object::contains(const py::object &key) const {
+    if (!pyutils::all_nonnull(*this, key)) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    return PySet_Contains(ob, key);
+}
+
+int s::object::add(const py::object &key) const {
+    if (!pyutils::all_nonnull(*this, key)) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    return PySet_Add(ob, key);
+}
+
+int s::object::discard(const py::object &key) const {
+    if (!pyutils::all_nonnull(*this, key)) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    return PySet_Discard(ob, key);
+}
+
+int s::object::update_iterable(PyObject *iterable) const {
+#if HAVE_SET_UPDATE
+    return _PySet_Update(ob, iterable);
+#else
+    pyutils::_pending_error pending;
+    PyObject *it = PyObject_GetIter(iterable);
+    if (!it) {
+        return -1;
+    }
+    PyObject *item;
+    while ((item = PyIter_Next(it))) {
+        int err = PySet_Add(ob, item);
+        Py_DECREF(item);
+        if (err) {
+            Py_DECREF(it);
+            return -1;
+        }
+    }
+    // `PyIter_Next` returns nullptr at the end and on error, check before
+    // releasing the iterator can run other code
+    bool failed = PyErr_Occurred();
+    Py_DECREF(it);
+    return failed ? -1 : 0;
+#endif
+}
+
+int s::object::update(const py::object &other) const {
+    if (!pyutils::all_nonnull(*this, other)) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    if (!PySet_Check(ob)) {
+        PyErr_BadInternalCall();
+        return -1;
+    }
+    return update_iterable(other);
+}
+
+int s::object::difference_update(const py::object &other) const {
+    if (!pyutils::all_nonnull(*this, other)) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    if (static_cast<PyObject*>(other) == ob) {
+        // iterating the set while discarding from it would raise
+        return PySet_Clear(ob);
+    }
+    pyutils::_pending_error pending;
+    PyObject *it = PyObject_GetIter(other);
+    if (!it) {
+        return -1;
+    }
+    PyObject *item;
+    while ((item = PyIter_Next(it))) {
+        int err = PySet_Discard(ob, item);
+        Py_DECREF(item);
+        if (err < 0) {
+            Py_DECREF(it);
+            return -1;
+        }
+    }
+    // `PyIter_Next` returns nullptr at the end and on error, check before
+    // releasing the iterator can run other code
+    bool failed = PyErr_Occurred();
+    Py_DECREF(it);
+    return failed ? -1 : 0;
+}
+
+py::nonnull<s::object> s::object::as_nonnull() const {
+    if (!is_nonnull()) {
+        throw pyutils::bad_nonnull();
+    }
+    return nonnull<s::object>(ob);
+}
+
+py::tmpref<s::object> s::object::as_tmpref() && {
+    tmpref<s::object> ret(ob);
+    ob = nullptr;
+    return ret;
+}
@@ -0,0 +1,153 @@
+#include "libpy/str.h"
+#include "libpy/utils.h"
+
+namespace s = py::str;
+
+const py::type::object<s::object>
+s::type(reinterpret_cast<PyObject*>(&PyUnicode_Type));
+
+s::object::object() : py::object() {}
+
+s::object::object(PyObject *pob) : py::object(pob) {
+    str_check();
+}
+
+s::object::object(const py::object &pob) : py::object(pob) {
+    str_check();
+}
+
+s::object::object(const s::object &cpfrom) : py::object(cpfrom.ob) {}
+
+s::object::object(s::object &&mvfrom) noexcept : py::object(mvfrom.ob) {
+    mvfrom.ob = nullptr;
+}
+
+void s::object::str_check() {
+    if (ob && !PyUnicode_Check(ob)) {
+        ob = nullptr;
+        if (!PyErr_Occurred()) {
+            PyErr_SetString(PyExc_TypeError,
+                            "cannot make py::str::object from non str");
+        }
+    }
+}
+
+py::ssize_t s::object::len() const {
+    if (!is_nonnull()) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    if (!ready()) {
+        return -1;
+    }
+    return PyUnicode_GET_LENGTH(ob);
+}
+
+py::hash_t s::object::hash() const {
+    if (!is_nonnull()) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    py::hash_t cached = reinterpret_cast<PyASCIIObject*>(ob)->hash;
+    if (cached != -1) {
+        return cached;
+    }
+    return PyObject_Hash(ob);
+}
+
+int s::object::is_ascii() const {
+    if (!is_nonnull()) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    if (!ready()) {
+        return -1;
+    }
+    return PyUnicode_IS_ASCII(ob);
+}
+
+int s::object::kind() const {
+    if (!is_nonnull()) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    if (!ready()) {
+        return -1;
+    }
+    return PyUnicode_KIND(ob);
+}
+
+const void *s::object::data() const {
+    if (!is_nonnull()) {
+        pyutils::failed_null_check();
+        return nullptr;
+    }
+    if (!ready()) {
+        return nullptr;
+    }
+    return PyUnicode_DATA(ob);
+}
+
+namespace {
+/**
+   Get the storage of `self` if it has the given kind.
+*/
+template<typename T>
+const T *kind_data(const s::object &self, int expected) {
+    int kind = self.kind();
+    if (kind < 0) {
+        return nullptr;
+    }
+    if (kind != expected) {
+        PyErr_Format(PyExc_ValueError,
+                     "expected a string of kind %d, got kind %d",
+                     expected,
+                     kind);
+        return nullptr;
+    }
+    return static_cast<const T*>(self.data());
+}
+}
+
+const Py_UCS1 *s::object::ucs1() const {
+    return kind_data<Py_UCS1>(*this, PyUnicode_1BYTE_KIND);
+}
+
+const Py_UCS2 *s::object::ucs2() const {
+    return kind_data<Py_UCS2>(*this, PyUnicode_2BYTE_KIND);
+}
+
+const Py_UCS4 *s::object::ucs4() const {
+    return kind_data<Py_UCS4>(*this, PyUnicode_4BYTE_KIND);
+}
+
+s::string_view s::object::utf8() const {
+    if (!is_nonnull()) {
+        pyutils::failed_null_check();
+        return s::string_view();
+    }
+    if (PyUnicode_IS_COMPACT_ASCII(ob)) {
+        return s::string_view(reinterpret_cast<const char*>(PyUnicode_DATA(ob)),
+                              PyUnicode_GET_LENGTH(ob));
+    }
+
+    py::ssize_t size;
+    const char *utf8 = PyUnicode_AsUTF8AndSize(ob, &size);
+    if (!utf8) {
+        return s::string_view();
+    }
+    return s::string_view(utf8, size);
+}
+
+py::nonnull<s::object> s::object::as_nonnull() const {
+    if (!is_nonnull()) {
+        throw pyutils::bad_nonnull();
+    }
+    return nonnull<s::object>(ob);
+}
+
+py::tmpref<s::object> s::object::as_tmpref() && {
+    tmpref<s::object> ret(ob);
+    ob = nullptr;
+    return ret;
+}
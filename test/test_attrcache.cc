@@ -0,0 +1,132 @@
+#include "gtest/gtest.h"
+#include <Python.h>
+
+#include "libpy/libpy.h"
+#include "utils.h"
+
+using py::operator""_p;
+
+class AttrCache : public testing::Test {
+protected:
+    py::tmpref<py::object> ns;
+
+    virtual void SetUp() {
+        ns = make_namespace();
+        ASSERT_TRUE(ns.is_nonnull());
+        ASSERT_EQ(exec("class Slots:\n"
+                       "    __slots__ = ('x',)\n"
+                       "\n"
+                       "class Prop:\n"
+                       "    @property\n"
+                       "    def x(self):\n"
+                       "        return 'prop'\n"
+                       "\n"
+                       "class Plain:\n"
+                       "    def x(self):\n"
+                       "        return 'method'\n"
+                       "\n"
+                       "class GetAttr:\n"
+                       "    def __getattr__(self, name):\n"
+                       "        return name\n",
+                       ns),
+                  0);
+    }
+};
+
+TEST_F(AttrCache, member) {
+    static py::attrcache cache("x"_p);
+
+    auto a = eval("Slots()", ns);
+    auto b = eval("Slots()", ns);
+    ASSERT_TRUE(pyutils::all_nonnull(a, b));
+    ASSERT_EQ(a.setattr("x"_p, 1_p), 0);
+    ASSERT_EQ(b.setattr("x"_p, 2_p), 0);
+
+    for (int n = 0; n < 2; ++n) {
+        EXPECT_IS(a.getattr(cache), 1_p);
+        EXPECT_IS(b.getattr(cache), 2_p);
+    }
+
+    ASSERT_EQ(b.delattr("x"_p), 0);
+    EXPECT_IS(b.getattr(cache), nullptr);
+    EXPECT_PYTHON_ERR(PyExc_AttributeError);
+}
+
+TEST_F(AttrCache, data_descriptor) {
+    static py::attrcache cache("x"_p);
+
+    auto ob = eval("Prop()", ns);
+    ASSERT_TRUE(ob.is_nonnull());
+
+    for (int n = 0; n < 2; ++n) {
+        EXPECT_TRUE((ob.getattr(cache) == "prop"_p).istrue());
+        EXPECT_NO_PYTHON_ERR();
+    }
+}
+
+TEST_F(AttrCache, type_attr) {
+    static py::attrcache cache("x"_p);
+
+    auto ob = eval("Plain()", ns);
+    ASSERT_TRUE(ob.is_nonnull());
+
+    for (int n = 0; n < 2; ++n) {
+        EXPECT_TRUE((ob.getattr(cache)() == "method"_p).istrue());
+        EXPECT_NO_PYTHON_ERR();
+    }
+
+    // the instance dict shadows non-data descriptors
+    ASSERT_EQ(ob.setattr("x"_p, 1_p), 0);
+    EXPECT_IS(ob.getattr(cache), 1_p);
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST_F(AttrCache, instance_attr) {
+    static py::attrcache cache("y"_p);
+
+    auto ob = eval("Plain()", ns);
+    ASSERT_TRUE(ob.is_nonnull());
+
+    EXPECT_IS(ob.getattr(cache), nullptr);
+    EXPECT_PYTHON_ERR(PyExc_AttributeError);
+
+    ASSERT_EQ(ob.setattr("y"_p, 1_p), 0);
+    EXPECT_IS(ob.getattr(cache), 1_p);
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST_F(AttrCache, type_modified) {
+    static py::attrcache cache("x"_p);
+
+    auto cls = eval("Plain", ns);
+    auto ob = eval("Plain()", ns);
+    ASSERT_TRUE(pyutils::all_nonnull(cls, ob));
+
+    EXPECT_TRUE((ob.getattr(cache)() == "method"_p).istrue());
+    ASSERT_EQ(cls.setattr("x"_p, 1_p), 0);
+    EXPECT_IS(ob.getattr(cache), 1_p);
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST_F(AttrCache, alternating_types) {
+    static py::attrcache cache("x"_p);
+
+    auto a = eval("Prop()", ns);
+    auto b = eval("Plain()", ns);
+    auto c = eval("GetAttr()", ns);
+    ASSERT_TRUE(pyutils::all_nonnull(a, b, c));
+
+    for (int n = 0; n < 2; ++n) {
+        EXPECT_TRUE((a.getattr(cache) == "prop"_p).istrue());
+        EXPECT_TRUE((b.getattr(cache)() == "method"_p).istrue());
+        EXPECT_TRUE((c.getattr(cache) == "x"_p).istrue());
+        EXPECT_NO_PYTHON_ERR();
+    }
+}
+
+TEST_F(AttrCache, nullptr) {
+    static py::attrcache cache("x"_p);
+
+    EXPECT_IS(py::object(nullptr).getattr(cache), nullptr);
+    EXPECT_PYTHON_ERR(PyExc_AssertionError);
+}
@@ -0,0 +1,519 @@
+#include <cstring>
+#include <string>
+
+#include "gtest/gtest.h"
+#include <Python.h>
+
+#include "libpy/automethod.h"
+#include "libpy/libpy.h"
+#include "utils.h"
+
+using py::operator""_p;
+using py::operator""_kw;
+
+namespace {
+PyObject *noargs(PyObject*) {
+    Py_RETURN_NONE;
+}
+
+PyObject *add(PyObject*, int a, long long b) {
+    return PyLong_FromLongLong(a + b);
+}
+
+PyObject *scale(PyObject*, double x, float y) {
+    return PyFloat_FromDouble(x * y);
+}
+
+PyObject *truthy(PyObject*, bool b) {
+    return PyBool_FromLong(b);
+}
+
+PyObject *length(PyObject*, const char *s) {
+    return PyLong_FromSize_t(s ? std::strlen(s) : 0);
+}
+
+PyObject *identity(PyObject*, py::object ob) {
+    return ob.incref();
+}
+
+PyObject *list_len(PyObject*, py::list::object l) {
+    return PyLong_FromSsize_t(l.len());
+}
+
+namespace ns {
+PyObject *sub(PyObject*, int a, int b) {
+    return PyLong_FromLong(a - b);
+}
+}
+
+PyObject *affine(PyObject*, double x, double scale, double shift) {
+    return PyFloat_FromDouble(x * scale + shift);
+}
+
+constexpr auto affine_params = pyutils::parameters(
+    "x"_kw,
+    pyutils::default_arg("scale"_kw, 1.0),
+    pyutils::default_arg("shift"_kw, 0.0));
+
+void returns_void(PyObject*) {}
+
+double returns_double(PyObject*, int a) {
+    return a / 2.0;
+}
+
+bool returns_bool(PyObject*, int a) {
+    return a > 0;
+}
+
+std::pair<long, std::string> returns_pair(PyObject*, long a) {
+    return {a, std::to_string(a)};
+}
+
+py::tmpref<py::object> returns_tmpref(PyObject*, py::object ob) {
+    return py::tuple::pack(ob);
+}
+
+py::object returns_object(PyObject*) {
+    return PyList_New(0);
+}
+
+PyObject *describe_long(PyObject*, long a) {
+    return PyUnicode_FromFormat("long %ld", a);
+}
+
+PyObject *describe_double(PyObject*, double a) {
+    return PyUnicode_FromFormat("double %d", static_cast<int>(a));
+}
+
+PyObject *describe_list(PyObject*, py::list::object l) {
+    return PyUnicode_FromFormat("list %zd", l.len());
+}
+
+PyObject *describe_set(PyObject*, py::set::object s) {
+    return PyUnicode_FromFormat("set %zd", s.len());
+}
+
+PyObject *describe_pair(PyObject*, long a, py::object b) {
+    return PyUnicode_FromFormat("pair %ld %R", a, static_cast<PyObject*>(b));
+}
+
+bool gil_held(PyObject*) {
+    return PyGILState_Check();
+}
+
+long sum_to(PyObject*, long n, bool check_gil) {
+    if (check_gil && PyGILState_Check()) {
+        return -1;
+    }
+    long total = 0;
+    for (long i = 0; i < n; ++i) {
+        total += i;
+    }
+    return total;
+}
+
+PyMethodDef noargs_def = automethod(noargs);
+PyMethodDef add_def = automethod(add, "add two numbers");
+PyMethodDef scale_def = automethod(scale);
+PyMethodDef truthy_def = automethod(truthy);
+PyMethodDef length_def = automethod(length);
+PyMethodDef identity_def = automethod(identity);
+PyMethodDef list_len_def = automethod(list_len);
+PyMethodDef sub_def = named_automethod("sub", ns::sub);
+PyMethodDef sub_doc_def = named_automethod("sub", ns::sub, "subtract");
+PyMethodDef returns_void_def = automethod(returns_void);
+PyMethodDef returns_double_def = automethod(returns_double);
+PyMethodDef returns_bool_def = automethod(returns_bool);
+PyMethodDef returns_pair_def = automethod(returns_pair);
+PyMethodDef returns_tmpref_def = automethod(returns_tmpref);
+PyMethodDef returns_object_def = automethod(returns_object);
+PyMethodDef describe_def = automethod_overloads("describe",
+                                                describe_long,
+                                                describe_double,
+                                                describe_list,
+                                                describe_set,
+                                                describe_pair);
+PyMethodDef describe_doc_def = automethod_overloads_doc("describe",
+                                                        "describe a value",
+                                                        describe_double);
+PyMethodDef gil_held_def = automethod(gil_held);
+PyMethodDef gil_held_nogil_def = automethod_nogil(gil_held);
+PyMethodDef sum_to_def = named_automethod_nogil("sum_to",
+                                                sum_to,
+                                                "sum without the gil");
+PyMethodDef affine_def = automethod_kw(affine, affine_params);
+PyMethodDef affine_doc_def = named_automethod_kw("f",
+                                                 affine,
+                                                 affine_params,
+                                                 "affine");
+}
+
+TEST(Automethod, flags) {
+    EXPECT_EQ(noargs_def.ml_flags, METH_NOARGS);
+    EXPECT_EQ(add_def.ml_flags, HAVE_FASTCALL ? METH_FASTCALL : METH_VARARGS);
+    EXPECT_STREQ(add_def.ml_name, "add");
+    EXPECT_STREQ(add_def.ml_doc, "add two numbers");
+    EXPECT_EQ(scale_def.ml_doc, nullptr);
+    EXPECT_EQ(truthy_def.ml_flags, METH_O);
+}
+
+TEST(Automethod, named) {
+    EXPECT_STREQ(sub_def.ml_name, "sub");
+    EXPECT_EQ(sub_def.ml_doc, nullptr);
+    EXPECT_STREQ(sub_doc_def.ml_name, "sub");
+    EXPECT_STREQ(sub_doc_def.ml_doc, "subtract");
+
+    auto f = function(sub_def);
+    ASSERT_TRUE(f.is_nonnull());
+    auto result = f(5_p, 3_p);
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == 2_p).istrue());
+}
+
+TEST(Automethod, noargs) {
+    auto f = function(noargs_def);
+    ASSERT_TRUE(f.is_nonnull());
+    EXPECT_IS(f(), Py_None);
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST(Automethod, integral) {
+    auto f = function(add_def);
+    ASSERT_TRUE(f.is_nonnull());
+
+    auto result = f(1_p, 2_p);
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == 3_p).istrue());
+
+    EXPECT_FALSE(f(1_p, 2.5_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    EXPECT_FALSE(f("a"_p, 2_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    py::tmpref<py::object> big(PyLong_FromLongLong(
+                                   static_cast<long long>(INT_MAX) + 1));
+    EXPECT_FALSE(f(big, 2_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_OverflowError);
+}
+
+TEST(Automethod, floating) {
+    auto f = function(scale_def);
+    ASSERT_TRUE(f.is_nonnull());
+
+    auto result = f(1.5_p, 2_p);
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == 3.0_p).istrue());
+
+    EXPECT_FALSE(f("a"_p, 2_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+}
+
+TEST(Automethod, bool_) {
+    auto f = function(truthy_def);
+    ASSERT_TRUE(f.is_nonnull());
+
+    EXPECT_IS(f(1_p), Py_True);
+    EXPECT_IS(f(""_p), Py_False);
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST(Automethod, string) {
+    auto f = function(length_def);
+    ASSERT_TRUE(f.is_nonnull());
+
+    auto result = f("abcd"_p);
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == 4_p).istrue());
+
+    result = f(py::object(Py_None));
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == 0_p).istrue());
+
+    EXPECT_FALSE(f(1_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    py::tmpref<py::object> embedded_null(
+        PyUnicode_FromStringAndSize("ab\0cd", 5));
+    ASSERT_TRUE(embedded_null.is_nonnull());
+    EXPECT_FALSE(f(embedded_null).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_ValueError);
+}
+
+TEST(Automethod, object) {
+    auto f = function(identity_def);
+    ASSERT_TRUE(f.is_nonnull());
+
+    auto ob = "ayy"_p;
+    EXPECT_IS(f(ob), ob);
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST(Automethod, list) {
+    auto f = function(list_len_def);
+    ASSERT_TRUE(f.is_nonnull());
+
+    py::tmpref<py::object> l(Py_BuildValue("[iii]", 0, 1, 2));
+    ASSERT_TRUE(l.is_nonnull());
+    auto result = f(l);
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == 3_p).istrue());
+
+    EXPECT_FALSE(f(py::tuple::pack(1_p)).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+}
+
+TEST(Automethod, wrong_arity) {
+    auto f = function(add_def);
+    ASSERT_TRUE(f.is_nonnull());
+
+    EXPECT_FALSE(f(1_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    EXPECT_FALSE(f(1_p, 2_p, 3_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    auto g = function(noargs_def);
+    EXPECT_FALSE(g(1_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    auto h = function(truthy_def);
+    EXPECT_FALSE(h().is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    EXPECT_FALSE(h(1_p, 2_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+}
+
+TEST(Automethod, kw_flags) {
+    EXPECT_EQ(affine_def.ml_flags,
+              (HAVE_FASTCALL ? METH_FASTCALL : METH_VARARGS) | METH_KEYWORDS);
+    EXPECT_STREQ(affine_def.ml_name, "affine");
+    EXPECT_EQ(affine_def.ml_doc, nullptr);
+    EXPECT_STREQ(affine_doc_def.ml_name, "f");
+    EXPECT_STREQ(affine_doc_def.ml_doc, "affine");
+}
+
+TEST(Automethod, kw_positional) {
+    auto f = function(affine_def);
+    ASSERT_TRUE(f.is_nonnull());
+
+    auto result = f(2_p, 3_p, 1_p);
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == 7.0_p).istrue());
+
+    EXPECT_FALSE(f(1_p, 2_p, 3_p, 4_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+}
+
+TEST(Automethod, kw_defaults) {
+    auto f = function(affine_def);
+    ASSERT_TRUE(f.is_nonnull());
+
+    auto result = f(2_p);
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == 2.0_p).istrue());
+
+    result = f(2_p, "shift"_kw = 1_p);
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == 3.0_p).istrue());
+
+    result = f("shift"_kw = 1_p, "x"_kw = 2_p, "scale"_kw = 3_p);
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == 7.0_p).istrue());
+}
+
+TEST(Automethod, kw_uninterned_name) {
+    auto f = function(affine_def);
+    ASSERT_TRUE(f.is_nonnull());
+
+    // build a name which is equal to but not the same object as the
+    // interned parameter name
+    py::tmpref<py::object> name(PyUnicode_FromString("shif"));
+    ASSERT_TRUE(name.is_nonnull());
+    PyUnicode_Append(reinterpret_cast<PyObject**>(&name), "t"_p);
+    ASSERT_TRUE(name.is_nonnull());
+
+    py::tmpref<py::object> kwargs(PyDict_New());
+    ASSERT_TRUE(kwargs.is_nonnull());
+    ASSERT_EQ(PyDict_SetItem(kwargs, name, 1_p), 0);
+
+    py::tmpref<py::object> args = py::tuple::pack(2_p);
+    py::tmpref<py::object> result(PyObject_Call(f, args, kwargs));
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == 3.0_p).istrue());
+}
+
+TEST(Automethod, kw_errors) {
+    auto f = function(affine_def);
+    ASSERT_TRUE(f.is_nonnull());
+
+    // missing required argument
+    EXPECT_FALSE(f("scale"_kw = 1_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    // unknown keyword
+    EXPECT_FALSE(f(1_p, "scal"_kw = 1_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    // passed by position and name
+    EXPECT_FALSE(f(1_p, "x"_kw = 1_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    // bad type for a keyword argument
+    EXPECT_FALSE(f(1_p, "shift"_kw = "a"_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+}
+
+TEST(Automethod, return_void) {
+    auto f = function(returns_void_def);
+    ASSERT_TRUE(f.is_nonnull());
+    EXPECT_IS(f(), Py_None);
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST(Automethod, return_scalar) {
+    auto f = function(returns_double_def);
+    ASSERT_TRUE(f.is_nonnull());
+    auto result = f(3_p);
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == 1.5_p).istrue());
+
+    auto g = function(returns_bool_def);
+    ASSERT_TRUE(g.is_nonnull());
+    EXPECT_IS(g(1_p), Py_True);
+    EXPECT_IS(g(0_p), Py_False);
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST(Automethod, return_pair) {
+    auto f = function(returns_pair_def);
+    ASSERT_TRUE(f.is_nonnull());
+    auto result = f(12_p);
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == py::tuple::pack(12_p, "12"_p)).istrue());
+}
+
+TEST(Automethod, return_tmpref) {
+    auto f = function(returns_tmpref_def);
+    ASSERT_TRUE(f.is_nonnull());
+
+    py::tmpref<py::object> ob(PyUnicode_FromString("ayy lmao"));
+    Py_ssize_t start = Py_REFCNT(ob);
+    {
+        auto result = f(ob);
+        EXPECT_NO_PYTHON_ERR();
+        EXPECT_TRUE((result == py::tuple::pack(ob)).istrue());
+    }
+    EXPECT_EQ(Py_REFCNT(ob), start);
+}
+
+TEST(Automethod, return_object) {
+    auto f = function(returns_object_def);
+    ASSERT_TRUE(f.is_nonnull());
+
+    // a returned `py::object` is a new reference, like a `PyObject*`
+    auto result = f();
+    EXPECT_NO_PYTHON_ERR();
+    ASSERT_TRUE(result.is_nonnull());
+    EXPECT_EQ(Py_REFCNT(result), 1);
+}
+
+TEST(Automethod, overloads) {
+    EXPECT_STREQ(describe_def.ml_name, "describe");
+    EXPECT_EQ(describe_def.ml_doc, nullptr);
+    EXPECT_STREQ(describe_doc_def.ml_doc, "describe a value");
+
+    auto f = function(describe_def);
+    ASSERT_TRUE(f.is_nonnull());
+
+    auto result = f(3_p);
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == "long 3"_p).istrue());
+
+    result = f(3.5_p);
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == "double 3"_p).istrue());
+
+    py::tmpref<py::object> l(Py_BuildValue("[ii]", 0, 1));
+    ASSERT_TRUE(l.is_nonnull());
+    result = f(l);
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == "list 2"_p).istrue());
+
+    result = f(1_p, "a"_p);
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == "pair 1 'a'"_p).istrue());
+
+    // sets and frozensets are both accepted by `py::set::object`
+    py::tmpref<py::object> s(PySet_New(l));
+    ASSERT_TRUE(s.is_nonnull());
+    result = f(s);
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == "set 2"_p).istrue());
+
+    py::tmpref<py::object> frozen(PyFrozenSet_New(l));
+    ASSERT_TRUE(frozen.is_nonnull());
+    result = f(frozen);
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == "set 2"_p).istrue());
+}
+
+TEST(Automethod, overloads_no_match) {
+    auto f = function(describe_def);
+    ASSERT_TRUE(f.is_nonnull());
+
+    // types must match exactly
+    EXPECT_FALSE(f(py::True).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    EXPECT_FALSE(f("a"_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    EXPECT_FALSE(f(1.5_p, 1_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    EXPECT_FALSE(f().is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+}
+
+TEST(Automethod, overloads_conversion_error) {
+    auto f = function(describe_def);
+    ASSERT_TRUE(f.is_nonnull());
+
+    // the selected overload may still fail to convert
+    py::tmpref<py::object> big(PyNumber_Lshift(1_p, 100_p));
+    ASSERT_TRUE(big.is_nonnull());
+    EXPECT_FALSE(f(big).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_OverflowError);
+}
+
+TEST(Automethod, nogil) {
+    auto held = function(gil_held_def);
+    ASSERT_TRUE(held.is_nonnull());
+    EXPECT_IS(held(), Py_True);
+
+    auto released = function(gil_held_nogil_def);
+    ASSERT_TRUE(released.is_nonnull());
+    EXPECT_IS(released(), Py_False);
+    EXPECT_NO_PYTHON_ERR();
+
+    // the gil is held again once the call returns
+    EXPECT_TRUE(PyGILState_Check());
+}
+
+TEST(Automethod, nogil_arguments) {
+    EXPECT_STREQ(sum_to_def.ml_name, "sum_to");
+    EXPECT_STREQ(sum_to_def.ml_doc, "sum without the gil");
+
+    auto f = function(sum_to_def);
+    ASSERT_TRUE(f.is_nonnull());
+
+    auto result = f(5_p, py::True);
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == 10_p).istrue());
+
+    // conversion errors are raised while holding the gil
+    EXPECT_FALSE(f("a"_p, py::True).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+}
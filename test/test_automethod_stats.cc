@@ -0,0 +1,211 @@
+#define LIBPY_AUTOMETHOD_STATS
+
+#include "gtest/gtest.h"
+#include <Python.h>
+
+#include "libpy/automethod.h"
+#include "libpy/libpy.h"
+#include "utils.h"
+
+using py::operator""_p;
+using py::operator""_kw;
+
+namespace {
+PyObject *counted_noargs(PyObject*) {
+    Py_RETURN_NONE;
+}
+
+long counted_negate(PyObject*, long a) {
+    return -a;
+}
+
+long counted_add(PyObject*, long a, long b) {
+    return a + b;
+}
+
+PyObject *counted_fail(PyObject*, long) {
+    PyErr_SetString(PyExc_ValueError, "failed");
+    return nullptr;
+}
+
+long shared_first(PyObject*) {
+    return 1;
+}
+
+long shared_second(PyObject*) {
+    return 2;
+}
+
+long counted_kw(PyObject*, long a, long b) {
+    return a - b;
+}
+
+long overload_long(PyObject*, long a) {
+    return -a;
+}
+
+double overload_double(PyObject*, double a) {
+    return -a;
+}
+
+constexpr auto counted_kw_params = pyutils::parameters(
+    "a"_kw,
+    pyutils::default_arg("b"_kw, 1));
+
+PyMethodDef counted_noargs_def = automethod(counted_noargs);
+PyMethodDef counted_negate_def = automethod(counted_negate);
+PyMethodDef counted_add_def = automethod(counted_add);
+PyMethodDef counted_fail_def = automethod(counted_fail);
+PyMethodDef shared_first_def = named_automethod("shared", shared_first);
+PyMethodDef shared_second_def = named_automethod("shared", shared_second);
+PyMethodDef counted_kw_def = automethod_kw(counted_kw, counted_kw_params);
+PyMethodDef counted_overloads_def = automethod_overloads("counted_overloads",
+                                                         overload_long,
+                                                         overload_double);
+PyMethodDef stats_def = named_automethod("automethod_stats",
+                                         pyutils::automethod_stats);
+
+py::object lookup(py::object stats, const char *key) {
+    return PyDict_GetItemString(stats, key);
+}
+
+unsigned long long as_ull(py::object ob) {
+    return PyLong_AsUnsignedLongLong(ob);
+}
+
+unsigned long long histogram_count(py::object timing) {
+    py::object histogram = lookup(timing, "histogram");
+    unsigned long long total = 0;
+    for (Py_ssize_t n = 0; n < PyList_Size(histogram); ++n) {
+        total += as_ull(PyList_GetItem(histogram, n));
+    }
+    return total;
+}
+}
+
+TEST(AutomethodStats, names) {
+    EXPECT_STREQ(counted_add_def.ml_name, "counted_add");
+    EXPECT_STREQ(stats_def.ml_name, "automethod_stats");
+    EXPECT_EQ(stats_def.ml_flags, METH_NOARGS);
+}
+
+TEST(AutomethodStats, counts) {
+    auto noargs = function(counted_noargs_def);
+    auto negate = function(counted_negate_def);
+    auto add = function(counted_add_def);
+    auto fail = function(counted_fail_def);
+    ASSERT_TRUE(noargs.is_nonnull());
+    ASSERT_TRUE(negate.is_nonnull());
+    ASSERT_TRUE(add.is_nonnull());
+    ASSERT_TRUE(fail.is_nonnull());
+
+    for (int n = 0; n < 3; ++n) {
+        EXPECT_IS(noargs(), Py_None);
+        EXPECT_EQ(PyLong_AsLong(negate(1_p)), -1);
+        EXPECT_TRUE((add(1_p, 2_p) == 3_p).istrue());
+    }
+    EXPECT_NO_PYTHON_ERR();
+
+    // fails while parsing
+    EXPECT_FALSE(add(1_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+    EXPECT_FALSE(negate("a"_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    // fails in the body
+    EXPECT_FALSE(fail(1_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_ValueError);
+
+    auto stats_function = function(stats_def);
+    ASSERT_TRUE(stats_function.is_nonnull());
+    auto stats = stats_function();
+    ASSERT_TRUE(stats.is_nonnull());
+    EXPECT_NO_PYTHON_ERR();
+    ASSERT_TRUE(PyDict_Check(static_cast<PyObject*>(stats)));
+
+    py::object noargs_stats = lookup(stats, "counted_noargs");
+    ASSERT_TRUE(noargs_stats.is_nonnull());
+    EXPECT_EQ(as_ull(lookup(noargs_stats, "calls")), 3ull);
+    EXPECT_EQ(as_ull(lookup(noargs_stats, "errors")), 0ull);
+    EXPECT_EQ(histogram_count(lookup(noargs_stats, "body")), 3ull);
+
+    py::object negate_stats = lookup(stats, "counted_negate");
+    ASSERT_TRUE(negate_stats.is_nonnull());
+    EXPECT_EQ(as_ull(lookup(negate_stats, "calls")), 4ull);
+    EXPECT_EQ(as_ull(lookup(negate_stats, "errors")), 1ull);
+    // calls which fail to parse are not timed
+    EXPECT_EQ(histogram_count(lookup(negate_stats, "parse")), 3ull);
+
+    py::object add_stats = lookup(stats, "counted_add");
+    ASSERT_TRUE(add_stats.is_nonnull());
+    EXPECT_EQ(as_ull(lookup(add_stats, "calls")), 4ull);
+    EXPECT_EQ(as_ull(lookup(add_stats, "errors")), 1ull);
+    for (const char *phase : {"parse", "body", "convert"}) {
+        py::object timing = lookup(add_stats, phase);
+        ASSERT_TRUE(timing.is_nonnull()) << phase;
+        EXPECT_EQ(histogram_count(timing), 3ull) << phase;
+        py::object total_ns = lookup(timing, "total_ns");
+        EXPECT_TRUE(PyLong_Check(static_cast<PyObject*>(total_ns))) << phase;
+    }
+
+    py::object fail_stats = lookup(stats, "counted_fail");
+    ASSERT_TRUE(fail_stats.is_nonnull());
+    EXPECT_EQ(as_ull(lookup(fail_stats, "calls")), 1ull);
+    EXPECT_EQ(as_ull(lookup(fail_stats, "errors")), 1ull);
+    EXPECT_EQ(histogram_count(lookup(fail_stats, "body")), 1ull);
+}
+
+TEST(AutomethodStats, histogram_buckets) {
+    using histogram = pyutils::automethod_histogram;
+    EXPECT_EQ(histogram::bucket(0), 0u);
+    EXPECT_EQ(histogram::bucket(1), 1u);
+    EXPECT_EQ(histogram::bucket(2), 2u);
+    EXPECT_EQ(histogram::bucket(3), 2u);
+    EXPECT_EQ(histogram::bucket(1024), 11u);
+    EXPECT_EQ(histogram::bucket(~0ull), histogram::nbuckets - 1);
+}
+
+TEST(AutomethodStats, shared_name) {
+    auto first = function(shared_first_def);
+    auto second = function(shared_second_def);
+    ASSERT_TRUE(pyutils::all_nonnull(first, second));
+
+    EXPECT_TRUE((first() == 1_p).istrue());
+    EXPECT_TRUE((second() == 2_p).istrue());
+    EXPECT_TRUE((second() == 2_p).istrue());
+
+    py::tmpref<py::object> stats(pyutils::automethod_stats());
+    ASSERT_TRUE(stats.is_nonnull());
+    py::object shared_stats = lookup(stats, "shared");
+    ASSERT_TRUE(shared_stats.is_nonnull());
+    EXPECT_EQ(as_ull(lookup(shared_stats, "calls")), 3ull);
+    EXPECT_EQ(histogram_count(lookup(shared_stats, "body")), 3ull);
+}
+
+TEST(AutomethodStats, kw_and_overloads) {
+    auto kw = function(counted_kw_def);
+    auto overloads = function(counted_overloads_def);
+    ASSERT_TRUE(pyutils::all_nonnull(kw, overloads));
+
+    EXPECT_TRUE((kw(3_p) == 2_p).istrue());
+    EXPECT_FALSE(kw().is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    EXPECT_TRUE((overloads(1_p) == -1_p).istrue());
+    EXPECT_TRUE((overloads(1.5_p) == -1.5_p).istrue());
+    EXPECT_NO_PYTHON_ERR();
+
+    py::tmpref<py::object> stats(pyutils::automethod_stats());
+    ASSERT_TRUE(stats.is_nonnull());
+
+    py::object kw_stats = lookup(stats, "counted_kw");
+    ASSERT_TRUE(kw_stats.is_nonnull());
+    EXPECT_EQ(as_ull(lookup(kw_stats, "calls")), 2ull);
+    EXPECT_EQ(as_ull(lookup(kw_stats, "errors")), 1ull);
+    EXPECT_EQ(histogram_count(lookup(kw_stats, "body")), 1ull);
+
+    py::object overload_stats = lookup(stats, "counted_overloads");
+    ASSERT_TRUE(overload_stats.is_nonnull());
+    EXPECT_EQ(as_ull(lookup(overload_stats, "calls")), 2ull);
+    EXPECT_EQ(histogram_count(lookup(overload_stats, "body")), 2ull);
+}
@@ -0,0 +1,134 @@
+#include <array>
+#include <cmath>
+
+#include "gtest/gtest.h"
+#include <Python.h>
+
+#include "libpy/automethod_vectorized.h"
+#include "libpy/libpy.h"
+#include "utils.h"
+
+using py::operator""_p;
+
+namespace {
+double axpy(double a, double x, long y) {
+    return a * x + y;
+}
+
+bool positive(double x) {
+    return x > 0;
+}
+
+PyMethodDef axpy_def = automethod_vectorized(axpy, "a * x + y");
+PyMethodDef positive_def = automethod_vectorized(positive);
+}
+
+TEST(AutomethodVectorized, def) {
+    EXPECT_STREQ(axpy_def.ml_name, "axpy");
+    EXPECT_STREQ(axpy_def.ml_doc, "a * x + y");
+    EXPECT_EQ(positive_def.ml_doc, nullptr);
+}
+
+TEST(AutomethodVectorized, scalars) {
+    auto f = function(axpy_def);
+    ASSERT_TRUE(f.is_nonnull());
+
+    auto result = f(2_p, 3_p, 1_p);
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE(PyFloat_CheckExact(static_cast<PyObject*>(result)));
+    EXPECT_TRUE((result == 7.0_p).istrue());
+}
+
+TEST(AutomethodVectorized, sequences) {
+    auto f = function(axpy_def);
+    ASSERT_TRUE(f.is_nonnull());
+
+    auto x = eval("[1, 2, 3]");
+    auto y = eval("(10, 20, 30)");
+    ASSERT_TRUE(x.is_nonnull() && y.is_nonnull());
+
+    auto result = f(2_p, x, y);
+    EXPECT_NO_PYTHON_ERR();
+    auto expected = eval("[12.0, 24.0, 36.0]");
+    EXPECT_TRUE((result == expected).istrue());
+
+    // all of the arguments may be sequences
+    auto a = eval("[1, 0, -1]");
+    result = f(a, x, y);
+    EXPECT_NO_PYTHON_ERR();
+    expected = eval("[11.0, 20.0, 27.0]");
+    EXPECT_TRUE((result == expected).istrue());
+
+    auto empty = eval("[]");
+    result = f(2_p, empty, empty);
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == empty).istrue());
+}
+
+TEST(AutomethodVectorized, buffers) {
+    auto f = function(axpy_def);
+    ASSERT_TRUE(f.is_nonnull());
+
+    auto x = eval("array.array('d', [1, 2, 3])");
+    auto y = eval("array.array('l', [10, 20, 30])");
+    ASSERT_TRUE(x.is_nonnull() && y.is_nonnull());
+
+    auto result = f(2_p, x, y);
+    EXPECT_NO_PYTHON_ERR();
+    ASSERT_TRUE(PyMemoryView_Check(static_cast<PyObject*>(result)));
+
+    Py_buffer *view = PyMemoryView_GET_BUFFER(static_cast<PyObject*>(result));
+    EXPECT_STREQ(view->format, "d");
+    ASSERT_EQ(view->len, static_cast<Py_ssize_t>(3 * sizeof(double)));
+    const double *data = static_cast<const double*>(view->buf);
+    EXPECT_EQ(data[0], 12.0);
+    EXPECT_EQ(data[1], 24.0);
+    EXPECT_EQ(data[2], 36.0);
+
+    // buffers and sequences may be mixed
+    auto list = eval("[10, 20, 30]");
+    result = f(2_p, x, list);
+    EXPECT_NO_PYTHON_ERR();
+    ASSERT_TRUE(PyMemoryView_Check(static_cast<PyObject*>(result)));
+}
+
+TEST(AutomethodVectorized, bool_result) {
+    auto f = function(positive_def);
+    ASSERT_TRUE(f.is_nonnull());
+
+    auto x = eval("[1.5, -1.0, 0.0]");
+    auto result = f(x);
+    EXPECT_NO_PYTHON_ERR();
+    auto expected = eval("[True, False, False]");
+    EXPECT_TRUE((result == expected).istrue());
+
+    auto buf = eval("array.array('d', [1.5, -1.0])");
+    result = f(buf);
+    EXPECT_NO_PYTHON_ERR();
+    ASSERT_TRUE(PyMemoryView_Check(static_cast<PyObject*>(result)));
+    EXPECT_STREQ(PyMemoryView_GET_BUFFER(
+                     static_cast<PyObject*>(result))->format,
+                 "?");
+}
+
+TEST(AutomethodVectorized, errors) {
+    auto f = function(axpy_def);
+    ASSERT_TRUE(f.is_nonnull());
+
+    auto x = eval("[1, 2, 3]");
+    auto short_y = eval("[1, 2]");
+    EXPECT_FALSE(f(2_p, x, short_y).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_ValueError);
+
+    auto bad_item = eval("[1, 'a', 3]");
+    EXPECT_FALSE(f(2_p, bad_item, x).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    // wrong buffer type for x
+    auto ints = eval("array.array('i', [1, 2, 3])");
+    EXPECT_FALSE(f(2_p, ints, x).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    EXPECT_FALSE(f(2_p, x).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+}
@@ -0,0 +1,193 @@
+#include <numeric>
+
+#include "gtest/gtest.h"
+#include <Python.h>
+
+#include "libpy/automethod.h"
+#include "libpy/libpy.h"
+#include "utils.h"
+
+using py::operator""_p;
+
+namespace {
+double sum(PyObject*, py::buffer_view<const double> values) {
+    return std::accumulate(values.begin(), values.end(), 0.0);
+}
+
+void scale(PyObject*, py::buffer_view<double> values, double factor) {
+    for (py::ssize_t ix = 0; ix < values.size(); ++ix) {
+        values[ix] *= factor;
+    }
+}
+
+long long count_bytes(PyObject*, py::buffer_view<const unsigned char> bytes) {
+    return bytes.size();
+}
+
+/**
+   A buffer exporter which records whether the GIL was held when its
+   buffer was released, and whether the `Py_buffer` which was released
+   is the one which was filled in.
+*/
+struct exporter {
+    double data[3] = {1, 2, 3};
+    Py_buffer *filled = nullptr;
+    int releases = 0;
+    int released_without_gil = 0;
+    int released_other_view = 0;
+};
+
+int exporter_getbuffer(PyObject *self, Py_buffer *view, int flags) {
+    exporter &ex = py::type::unbox<exporter>(self);
+    if (PyBuffer_FillInfo(view, self, ex.data, sizeof(ex.data), 0, flags)) {
+        return -1;
+    }
+    view->format = const_cast<char*>("d");
+    view->itemsize = sizeof(double);
+    ex.filled = view;
+    return 0;
+}
+
+void exporter_releasebuffer(PyObject *self, Py_buffer *view) {
+    exporter &ex = py::type::unbox<exporter>(self);
+    ++ex.releases;
+    if (view != ex.filled) {
+        ++ex.released_other_view;
+    }
+    if (!PyGILState_Check()) {
+        ++ex.released_without_gil;
+    }
+}
+
+PyMethodDef sum_def = automethod(sum);
+PyMethodDef sum_nogil_def = automethod_nogil(sum);
+PyMethodDef scale_def = automethod(scale);
+PyMethodDef count_bytes_def = automethod(count_bytes);
+}
+
+TEST(BufferView, acquire) {
+    auto arr = eval("array.array('d', [1, 2, 3])");
+    ASSERT_TRUE(arr.is_nonnull());
+
+    {
+        py::buffer_view<const double> view;
+        EXPECT_FALSE(view.acquired());
+        ASSERT_TRUE(view.acquire(arr));
+        EXPECT_TRUE(view.acquired());
+        EXPECT_IS(view.obj(), arr);
+        EXPECT_EQ(view.size(), 3);
+        EXPECT_EQ(view[2], 3.0);
+
+        py::buffer_view<const double> moved(std::move(view));
+        EXPECT_FALSE(view.acquired());
+        EXPECT_EQ(moved.size(), 3);
+
+        // an exported buffer prevents resizing
+        EXPECT_FALSE(arr.call_method("append"_p, 1.0_p).is_nonnull());
+        EXPECT_PYTHON_ERR(PyExc_BufferError);
+    }
+
+    // the buffer is released with the view
+    EXPECT_TRUE(arr.call_method("append"_p, 1.0_p).is_nonnull());
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST(BufferView, format) {
+    auto ints = eval("array.array('i', [1, 2, 3])");
+    ASSERT_TRUE(ints.is_nonnull());
+
+    py::buffer_view<const double> view;
+    EXPECT_FALSE(view.acquire(ints));
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+    EXPECT_FALSE(view.acquired());
+
+    auto longs = eval("array.array('q', [1, 2, 3])");
+    ASSERT_TRUE(longs.is_nonnull());
+    py::buffer_view<const long long> long_view;
+    EXPECT_TRUE(long_view.acquire(longs));
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST(BufferView, automethod) {
+    auto f = function(sum_def);
+    ASSERT_TRUE(f.is_nonnull());
+
+    auto arr = eval("array.array('d', [1, 2, 3.5])");
+    ASSERT_TRUE(arr.is_nonnull());
+
+    auto result = f(arr);
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == 6.5_p).istrue());
+
+    // the buffer is released after the call
+    EXPECT_TRUE(arr.call_method("append"_p, 1.0_p).is_nonnull());
+    EXPECT_NO_PYTHON_ERR();
+
+    auto g = function(sum_nogil_def);
+    ASSERT_TRUE(g.is_nonnull());
+    result = g(arr);
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == 7.5_p).istrue());
+
+    EXPECT_FALSE(f(1.0_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+}
+
+TEST(BufferView, nogil_release) {
+    auto type = py::type::builder<exporter>("test.exporter")
+        .slot(Py_bf_getbuffer, reinterpret_cast<void*>(exporter_getbuffer))
+        .slot(Py_bf_releasebuffer,
+              reinterpret_cast<void*>(exporter_releasebuffer))
+        .create();
+    ASSERT_TRUE(type.is_nonnull());
+    auto ob = type();
+    ASSERT_TRUE(ob.is_nonnull());
+
+    auto f = function(sum_nogil_def);
+    ASSERT_TRUE(f.is_nonnull());
+    auto result = f(ob);
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == 6.0_p).istrue());
+
+    // the buffer is released after the GIL is reacquired
+    exporter &ex = py::type::unbox<exporter>(ob);
+    EXPECT_EQ(ex.releases, 1);
+    EXPECT_EQ(ex.released_without_gil, 0);
+    // the argument was moved into the call, but not its `Py_buffer`
+    EXPECT_EQ(ex.released_other_view, 0);
+
+    py::buffer_view<const double> a;
+    ASSERT_TRUE(a.acquire(ob));
+    py::buffer_view<const double> b(std::move(a));
+    EXPECT_FALSE(a.acquired());
+    ASSERT_TRUE(b.acquired());
+    EXPECT_EQ(b[2], 3.0);
+    b = py::buffer_view<const double>();
+    EXPECT_EQ(ex.releases, 2);
+    EXPECT_EQ(ex.released_other_view, 0);
+}
+
+TEST(BufferView, writable) {
+    auto f = function(scale_def);
+    ASSERT_TRUE(f.is_nonnull());
+
+    auto arr = eval("array.array('d', [1, 2, 3])");
+    ASSERT_TRUE(arr.is_nonnull());
+
+    EXPECT_IS(f(arr, 2.0_p), Py_None);
+    EXPECT_NO_PYTHON_ERR();
+    auto expected = eval("array.array('d', [2, 4, 6])");
+    EXPECT_TRUE((arr == expected).istrue());
+
+    // bytes are read only
+    auto g = function(count_bytes_def);
+    ASSERT_TRUE(g.is_nonnull());
+    auto result = g("abc"_p.call_method("encode"_p));
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == 3_p).istrue());
+
+    auto memview = eval("memoryview(bytes(16)).cast('d')");
+    ASSERT_TRUE(memview.is_nonnull());
+    EXPECT_FALSE(f(memview, 2.0_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_BufferError);
+}
@@ -0,0 +1,160 @@
+#include <map>
+#include <string>
+#include <unordered_map>
+
+#include "gtest/gtest.h"
+#include <Python.h>
+
+#include "libpy/libpy.h"
+#include "utils.h"
+
+using py::operator""_p;
+
+TEST(Dict, type) {
+    ASSERT_EQ(static_cast<PyObject*>(py::dict::type),
+              reinterpret_cast<PyObject*>(&PyDict_Type));
+
+    auto d = py::dict::type();
+    EXPECT_EQ(static_cast<PyObject*>(d.type()),
+              reinterpret_cast<PyObject*>(&PyDict_Type));
+    EXPECT_EQ(d.len(), 0);
+}
+
+TEST(Dict, check) {
+    py::tmpref<py::object> d(PyDict_New());
+    EXPECT_EQ(py::dict::check(d), 1);
+    EXPECT_EQ(py::dict::checkexact(d), 1);
+    EXPECT_EQ(py::dict::check(1_p), 0);
+
+    py::dict::object not_dict(1_p);
+    EXPECT_FALSE(not_dict.is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+}
+
+TEST(Dict, get) {
+    py::tmpref<py::dict::object> d(PyDict_New());
+    ASSERT_TRUE(d.is_nonnull());
+    ASSERT_EQ(d.setitem(1_p, 2_p), 0);
+
+    EXPECT_IS(d.get(1_p), 2_p);
+    EXPECT_EQ(d.contains(1_p), 1);
+
+    // a missing key is not an error
+    EXPECT_FALSE(d.get(2_p).is_nonnull());
+    EXPECT_EQ(d.contains(2_p), 0);
+    EXPECT_NO_PYTHON_ERR();
+
+    // an unhashable key is
+    py::tmpref<py::object> unhashable(PyList_New(0));
+    EXPECT_FALSE(d.get(unhashable).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    ASSERT_EQ(d.delitem(1_p), 0);
+    EXPECT_EQ(d.len(), 0);
+    EXPECT_EQ(d.delitem(1_p), -1);
+    EXPECT_PYTHON_ERR(PyExc_KeyError);
+}
+
+TEST(Dict, known_hash) {
+    py::tmpref<py::dict::object> a(PyDict_New());
+    py::tmpref<py::dict::object> b(PyDict_New());
+    py::tmpref<py::object> key(PyUnicode_FromString("key"));
+    py::hash_t hash = key.hash();
+    ASSERT_NE(hash, -1);
+
+    ASSERT_EQ(a.setitem(key, hash, 1_p), 0);
+    ASSERT_EQ(b.setitem(key, 2_p), 0);
+
+    EXPECT_IS(a.get(key, hash), 1_p);
+    EXPECT_IS(b.get(key, hash), 2_p);
+    EXPECT_EQ(a.contains(key, hash), 1);
+
+    py::tmpref<py::object> other(PyUnicode_FromString("other"));
+    EXPECT_FALSE(a.get(other, other.hash()).is_nonnull());
+    EXPECT_EQ(b.contains(other, other.hash()), 0);
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST(Dict, iteration) {
+    py::tmpref<py::dict::object> d(PyDict_New());
+    ASSERT_EQ(d.setitem(0_p, 1_p), 0);
+    ASSERT_EQ(d.setitem(1_p, 2_p), 0);
+    ASSERT_EQ(d.setitem(2_p, 3_p), 0);
+
+    long n = 0;
+    for (const auto &item : d) {
+        EXPECT_EQ(PyLong_AsLong(item.first), n);
+        EXPECT_EQ(PyLong_AsLong(item.second), n + 1);
+        ++n;
+    }
+    EXPECT_EQ(n, 3);
+
+    py::tmpref<py::dict::object> empty(PyDict_New());
+    EXPECT_TRUE(empty.begin() == empty.end());
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST(Dict, iteration_changed_size) {
+    py::tmpref<py::dict::object> d(PyDict_New());
+    ASSERT_EQ(d.setitem(0_p, 1_p), 0);
+    ASSERT_EQ(d.setitem(1_p, 2_p), 0);
+
+    long n = 0;
+    for (const auto &item : d) {
+        (void) item;
+        py::tmpref<py::object> key(PyLong_FromLong(n + 10));
+        ASSERT_EQ(d.setitem(key, 0_p), 0);
+        ++n;
+    }
+    EXPECT_EQ(n, 1);
+    EXPECT_PYTHON_ERR(PyExc_RuntimeError);
+}
+
+TEST(Dict, from_map) {
+    std::map<std::string, long> values = {{"a", 1}, {"b", 2}};
+    auto d = py::dict::from_map(values);
+    ASSERT_TRUE(d.is_nonnull());
+    ASSERT_EQ(d.len(), 2);
+
+    py::tmpref<py::object> a(PyUnicode_FromString("a"));
+    EXPECT_EQ(PyLong_AsLong(d.get(a)), 1);
+
+    std::unordered_map<long, double> doubles = {{1, 0.5}};
+    auto from_unordered = py::dict::from_map(doubles);
+    ASSERT_TRUE(from_unordered.is_nonnull());
+    EXPECT_EQ(PyFloat_AsDouble(from_unordered.get(1_p)), 0.5);
+    EXPECT_NO_PYTHON_ERR();
+
+    std::map<std::string, long> bad = {{"\xff", 1}};
+    EXPECT_FALSE(py::dict::from_map(bad).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_UnicodeDecodeError);
+}
+
+TEST(Dict, from_range_input_iterator) {
+    // a generator is only traversed once
+    auto gen = eval("(c for c in 'abc')");
+    ASSERT_TRUE(gen.is_nonnull());
+    auto pairs = py::iter::enumerate(py::object(gen));
+    auto d = py::dict::from_range(pairs.begin(), pairs.end());
+    ASSERT_TRUE(d.is_nonnull());
+    EXPECT_TRUE((d == eval("{0: 'a', 1: 'b', 2: 'c'}")).istrue());
+    EXPECT_NO_PYTHON_ERR();
+
+    auto failing = eval("(1 // n for n in (1, 0))");
+    ASSERT_TRUE(failing.is_nonnull());
+    auto failing_pairs = py::iter::enumerate(py::object(failing));
+    EXPECT_FALSE(py::dict::from_range(failing_pairs.begin(),
+                                      failing_pairs.end()).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_ZeroDivisionError);
+}
+
+TEST(Dict, presized) {
+    auto d = py::dict::presized(1000);
+    ASSERT_TRUE(d.is_nonnull());
+    EXPECT_EQ(d.len(), 0);
+    for (long ix = 0; ix < 1000; ++ix) {
+        py::tmpref<py::object> key(PyLong_FromLong(ix));
+        ASSERT_EQ(d.setitem(key, key), 0);
+    }
+    EXPECT_EQ(d.len(), 1000);
+}
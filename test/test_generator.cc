@@ -0,0 +1,121 @@
+#include <stdexcept>
+#include <string>
+
+#include "gtest/gtest.h"
+#include <Python.h>
+
+#include "libpy/libpy.h"
+#include "utils.h"
+
+using py::operator""_p;
+
+namespace {
+py::tmpref<py::object> eval_with(const char *expr, py::object gen) {
+    py::tmpref<py::object> ns = make_namespace();
+    if (!ns.is_nonnull() || PyDict_SetItemString(ns, "gen", gen)) {
+        return nullptr;
+    }
+    return eval(expr, ns);
+}
+
+py::tmpref<py::object> count_to(long n) {
+    long ix = 0;
+    return py::generator([ix, n](long &out) mutable {
+            if (ix >= n) {
+                return false;
+            }
+            out = ix++;
+            return true;
+        });
+}
+
+int live_functors = 0;
+
+struct counted {
+    int remaining;
+
+    explicit counted(int remaining) : remaining(remaining) {
+        ++live_functors;
+    }
+
+    counted(counted &&mvfrom) : remaining(mvfrom.remaining) {
+        ++live_functors;
+    }
+
+    ~counted() {
+        --live_functors;
+    }
+
+    bool operator()(std::string &out) {
+        if (!remaining) {
+            return false;
+        }
+        out = std::to_string(remaining--);
+        return true;
+    }
+};
+}
+
+TEST(Generator, iterate) {
+    auto gen = count_to(5);
+    ASSERT_TRUE(gen.is_nonnull());
+    EXPECT_TRUE(PyIter_Check(static_cast<PyObject*>(gen)));
+
+    auto result = eval_with("list(gen)", gen);
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == eval_with("[0, 1, 2, 3, 4]", gen)).istrue());
+
+    // exhausted generators stay exhausted
+    EXPECT_TRUE((eval_with("list(gen)", gen) == eval_with("[]", gen)).istrue());
+    EXPECT_IS(eval_with("iter(gen) is gen", gen), Py_True);
+}
+
+TEST(Generator, functor) {
+    {
+        auto gen = py::generator(counted(2));
+        ASSERT_TRUE(gen.is_nonnull());
+        EXPECT_EQ(live_functors, 1);
+
+        auto result = eval_with("list(gen)", gen);
+        EXPECT_NO_PYTHON_ERR();
+        EXPECT_TRUE((result == eval_with("['2', '1']", gen)).istrue());
+    }
+    EXPECT_EQ(live_functors, 0);
+}
+
+TEST(Generator, type_is_shared) {
+    auto a = count_to(1);
+    auto b = count_to(2);
+    ASSERT_TRUE(a.is_nonnull());
+    ASSERT_TRUE(b.is_nonnull());
+    EXPECT_EQ(Py_TYPE(static_cast<PyObject*>(a)),
+              Py_TYPE(static_cast<PyObject*>(b)));
+
+    // generators may only be created from C++
+    auto type = eval_with("type(gen)", a);
+    ASSERT_TRUE(type.is_nonnull());
+    EXPECT_FALSE(type().is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+}
+
+TEST(Generator, errors) {
+    int calls = 0;
+    auto python_error = py::generator([&calls](long&) {
+            ++calls;
+            PyErr_SetString(PyExc_ValueError, "bad value");
+            return false;
+        });
+    ASSERT_TRUE(python_error.is_nonnull());
+    EXPECT_FALSE(eval_with("list(gen)", python_error).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_ValueError);
+    EXPECT_TRUE((eval_with("list(gen)", python_error) ==
+                 eval_with("[]", python_error)).istrue());
+    EXPECT_EQ(calls, 1);
+
+    auto cxx_error = py::generator([](long&) -> bool {
+            throw std::runtime_error("bad value");
+        });
+    ASSERT_TRUE(cxx_error.is_nonnull());
+    EXPECT_FALSE(eval_with("list(gen)", cxx_error).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_RuntimeError);
+}
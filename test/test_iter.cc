@@ -0,0 +1,187 @@
+#include <vector>
+
+#include "gtest/gtest.h"
+#include <Python.h>
+
+#include "libpy/libpy.h"
+#include "utils.h"
+
+using py::operator""_p;
+
+TEST(Iter, chunked) {
+    auto gen = eval("(n for n in range(7))");
+    ASSERT_TRUE(gen.is_nonnull());
+
+    std::vector<py::ssize_t> sizes;
+    long expected = 0;
+    for (const auto &block : py::iter::chunked(gen, 3)) {
+        sizes.push_back(block.size());
+        for (const py::object &item : block) {
+            EXPECT_EQ(PyLong_AsLong(item), expected++);
+        }
+    }
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_EQ(expected, 7);
+    EXPECT_EQ(sizes, (std::vector<py::ssize_t>{3, 3, 1}));
+}
+
+TEST(Iter, chunked_owns_items) {
+    auto list = py::list::pack(1000000_p);
+    Py_ssize_t refcnt = Py_REFCNT(static_cast<PyObject*>(list[0]));
+    {
+        py::iter::chunked blocks(list, 4);
+        auto it = blocks.begin();
+        ASSERT_NE(it, blocks.end());
+        EXPECT_EQ((*it).size(), 1);
+        EXPECT_IS((*it)[0], list[0]);
+        EXPECT_EQ(Py_REFCNT(static_cast<PyObject*>(list[0])), refcnt + 1);
+    }
+    EXPECT_EQ(Py_REFCNT(static_cast<PyObject*>(list[0])), refcnt);
+}
+
+TEST(Iter, chunked_empty) {
+    py::iter::chunked blocks(py::list::object(py::ssize_t(0)), 4);
+    EXPECT_EQ(blocks.begin(), blocks.end());
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST(Iter, chunked_error) {
+    auto gen = eval("(1 // n for n in (1, 1, 0, 1))");
+    ASSERT_TRUE(gen.is_nonnull());
+
+    std::size_t blocks = 0;
+    for (const auto &block : py::iter::chunked(gen, 2)) {
+        EXPECT_EQ(block.size(), 2);
+        ++blocks;
+    }
+    EXPECT_EQ(blocks, 1u);
+    EXPECT_PYTHON_ERR(PyExc_ZeroDivisionError);
+}
+
+TEST(Iter, chunked_invalid) {
+    for (const auto &block : py::iter::chunked(1_p, 2)) {
+        (void) block;
+        FAIL() << "int is not iterable";
+    }
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    for (const auto &block : py::iter::chunked(py::list::pack(1_p), 0)) {
+        (void) block;
+        FAIL() << "chunk size is invalid";
+    }
+    EXPECT_PYTHON_ERR(PyExc_ValueError);
+}
+
+TEST(Iter, map) {
+    auto list = py::list::pack(1_p, 2_p, 3_p);
+    std::vector<long> out;
+    for (long n : py::iter::map(list, [](const py::object &ob) {
+                return PyLong_AsLong(ob) * 2;
+            })) {
+        out.push_back(n);
+    }
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_EQ(out, (std::vector<long>{2, 4, 6}));
+}
+
+TEST(Iter, filter) {
+    auto gen = eval("(n for n in range(10))");
+    ASSERT_TRUE(gen.is_nonnull());
+
+    auto odd = [](const py::object &ob) { return PyLong_AsLong(ob) % 2; };
+    auto result = py::iter::collect(py::iter::filter(py::object(gen), odd));
+    EXPECT_NO_PYTHON_ERR();
+    auto expected = eval("[1, 3, 5, 7, 9]");
+    EXPECT_TRUE((result == expected).istrue());
+}
+
+TEST(Iter, enumerate) {
+    auto tuple = py::tuple::pack("a"_p, "b"_p);
+    std::vector<py::ssize_t> indices;
+    for (const auto &pair : py::iter::enumerate(tuple, 1)) {
+        indices.push_back(pair.first);
+        EXPECT_IS(pair.second, tuple[pair.first - 1]);
+    }
+    EXPECT_EQ(indices, (std::vector<py::ssize_t>{1, 2}));
+
+    auto result = py::iter::collect(py::iter::enumerate(tuple));
+    EXPECT_NO_PYTHON_ERR();
+    auto expected = eval("[(0, 'a'), (1, 'b')]");
+    EXPECT_TRUE((result == expected).istrue());
+}
+
+TEST(Iter, take) {
+    auto it = eval("iter(range(10))");
+    ASSERT_TRUE(it.is_nonnull());
+
+    auto result = py::iter::collect(py::iter::take(py::object(it), 3));
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == eval("[0, 1, 2]")).istrue());
+
+    // items after the first 3 are left in the iterator
+    auto rest = py::iter::collect(py::object(it));
+    EXPECT_TRUE((rest == eval("list(range(3, 10))")).istrue());
+
+    auto list = py::list::pack(1_p);
+    EXPECT_TRUE((py::iter::collect(py::iter::take(list, 5)) == list).istrue());
+    EXPECT_TRUE(
+        (py::iter::collect(py::iter::take(list, 0)) == eval("[]")).istrue());
+
+    // taking nothing does not pull an item out of a generator
+    auto gen = eval("(n for n in range(3))");
+    ASSERT_TRUE(gen.is_nonnull());
+    auto none = py::iter::collect(py::iter::take(py::object(gen), 0));
+    EXPECT_TRUE((none == eval("[]")).istrue());
+    rest = py::iter::collect(py::object(gen));
+    EXPECT_TRUE((rest == eval("[0, 1, 2]")).istrue());
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST(Iter, zip) {
+    auto list = py::list::pack(1_p, 2_p, 3_p);
+    auto gen = eval("(c for c in 'ab')");
+    ASSERT_TRUE(gen.is_nonnull());
+
+    auto result = py::iter::collect(py::iter::zip(list, py::object(gen)));
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == eval("[(1, 'a'), (2, 'b')]")).istrue());
+}
+
+TEST(Iter, fused) {
+    // one pass, only the outputs become Python objects
+    auto range = eval("range(20)");
+    ASSERT_TRUE(range.is_nonnull());
+
+    auto square = [](const py::object &ob) {
+        long n = PyLong_AsLong(ob);
+        return n * n;
+    };
+    auto even = [](long n) { return n % 2 == 0; };
+    auto result = py::iter::collect(
+        py::iter::take(py::iter::filter(py::iter::map(py::object(range),
+                                                      square),
+                                        even),
+                       4));
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == eval("[0, 4, 16, 36]")).istrue());
+}
+
+TEST(Iter, collect_error) {
+    auto gen = eval("(1 // n for n in (1, 0))");
+    ASSERT_TRUE(gen.is_nonnull());
+    EXPECT_FALSE(py::iter::collect(py::object(gen)).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_ZeroDivisionError);
+}
+
+TEST(Iter, collect_pending_error) {
+    auto range = eval("range(3)");
+    ASSERT_TRUE(range.is_nonnull());
+
+    // an exception which was already pending is not reported as a failure
+    // and is left in place
+    PyErr_SetString(PyExc_ValueError, "pending");
+    auto result = py::iter::collect(py::object(range));
+    ASSERT_TRUE(result.is_nonnull());
+    EXPECT_EQ(result.len(), 3);
+    EXPECT_PYTHON_ERR(PyExc_ValueError);
+}
@@ -1,6 +1,8 @@
 #include <array>
+#include <string>
 #include <tuple>
 #include <typeinfo>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include <Python.h>
@@ -53,3 +55,244 @@ TEST(List, iteration) {
     }
     EXPECT_EQ(n, 3u) << "ran through too many iterations";
 }
+
+TEST(List, from_range) {
+    std::vector<long> values = {1, 2, 3};
+    auto ob = py::list::from_range(values.begin(), values.end());
+    ASSERT_TRUE(ob.is_nonnull());
+    EXPECT_TRUE((ob == py::list::pack(1_p, 2_p, 3_p)).istrue());
+
+    std::array<double, 2> doubles = {0.5, 1.5};
+    auto from_array = py::list::from_range(doubles.begin(), doubles.end());
+    ASSERT_TRUE(from_array.is_nonnull());
+    ASSERT_EQ(from_array.len(), 2);
+    EXPECT_EQ(PyFloat_AsDouble(from_array[0]), 0.5);
+    EXPECT_EQ(PyFloat_AsDouble(from_array[1]), 1.5);
+
+    auto empty = py::list::from_range(values.end(), values.end());
+    ASSERT_TRUE(empty.is_nonnull());
+    EXPECT_EQ(empty.len(), 0);
+}
+
+TEST(List, from_range_vector) {
+    auto ob = py::list::from_range(std::vector<std::string>{"a", "bc"});
+    ASSERT_TRUE(ob.is_nonnull());
+    ASSERT_EQ(ob.len(), 2);
+    EXPECT_STREQ(PyUnicode_AsUTF8(ob[0]), "a");
+    EXPECT_STREQ(PyUnicode_AsUTF8(ob[1]), "bc");
+
+    const std::vector<bool> flags = {true, false};
+    auto from_flags = py::list::from_range(flags);
+    ASSERT_TRUE(from_flags.is_nonnull());
+    EXPECT_IS(from_flags[0], Py_True);
+    EXPECT_IS(from_flags[1], Py_False);
+}
+
+TEST(List, from_range_steals) {
+    PyObject *item = PyLong_FromLong(1000000);
+    ASSERT_TRUE(item);
+    Py_INCREF(item);
+    Py_ssize_t refcnt = Py_REFCNT(item);
+
+    std::vector<py::tmpref<py::object>> refs;
+    refs.emplace_back(item);
+    auto ob = py::list::from_range(std::move(refs));
+    ASSERT_TRUE(ob.is_nonnull());
+    EXPECT_IS(ob[0], item);
+    // the reference moved from the vector into the list
+    EXPECT_EQ(Py_REFCNT(item), refcnt);
+
+    ob.decref();
+    std::move(ob).invalidate();
+    EXPECT_EQ(Py_REFCNT(item), refcnt - 1);
+    Py_DECREF(item);
+}
+
+TEST(List, from_range_error) {
+    std::vector<std::string> values = {"a", "\xff", "b"};
+    auto ob = py::list::from_range(values);
+    EXPECT_FALSE(ob.is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_UnicodeDecodeError);
+}
+
+TEST(List, from_range_input_iterator) {
+    // a generator is only traversed once
+    auto gen = eval("(str(n) for n in range(3))");
+    ASSERT_TRUE(gen.is_nonnull());
+    auto ob = py::list::from_range(gen.begin(), gen.end());
+    ASSERT_TRUE(ob.is_nonnull());
+    EXPECT_TRUE((ob == eval("['0', '1', '2']")).istrue());
+    EXPECT_NO_PYTHON_ERR();
+
+    auto failing = eval("(1 // n for n in (1, 0))");
+    ASSERT_TRUE(failing.is_nonnull());
+    EXPECT_FALSE(py::list::from_range(failing.begin(),
+                                      failing.end()).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_ZeroDivisionError);
+}
+
+TEST(List, from_range_null) {
+    std::vector<py::object> values = {py::object(Py_None), nullptr};
+    EXPECT_FALSE(py::list::from_range(values).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_AssertionError);
+}
+
+TEST(List, reserve) {
+    py::tmpref<py::list::object> ob(PyList_New(0));
+    ASSERT_TRUE(ob.is_nonnull());
+    EXPECT_EQ(ob.capacity(), 0);
+
+    ASSERT_EQ(ob.reserve(16), 0);
+    EXPECT_EQ(ob.capacity(), 16);
+    EXPECT_EQ(ob.len(), 0);
+
+    PyObject **storage = reinterpret_cast<PyListObject*>(
+        static_cast<PyObject*>(ob))->ob_item;
+    for (long ix = 0; ix < 16; ++ix) {
+        py::tmpref<py::object> item(PyLong_FromLong(ix));
+        ASSERT_EQ(ob.append(item), 0);
+    }
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_EQ(ob.len(), 16);
+    EXPECT_EQ(ob.capacity(), 16);
+    // the reserved storage was filled without reallocating
+    EXPECT_EQ(reinterpret_cast<PyListObject*>(
+                  static_cast<PyObject*>(ob))->ob_item,
+              storage);
+    EXPECT_EQ(PyLong_AsLong(ob[15]), 15);
+
+    // reserving less than the capacity is a no-op
+    ASSERT_EQ(ob.reserve(4), 0);
+    EXPECT_EQ(ob.capacity(), 16);
+
+    // appending past the capacity grows the list as usual
+    ASSERT_EQ(ob.append(ob[0]), 0);
+    EXPECT_EQ(ob.len(), 17);
+    EXPECT_GE(ob.capacity(), 17);
+}
+
+TEST(List, shrink_to_fit) {
+    py::tmpref<py::list::object> ob(PyList_New(0));
+    ASSERT_EQ(ob.reserve(8), 0);
+    ASSERT_EQ(ob.append(py::object(Py_None)), 0);
+
+    ASSERT_EQ(ob.shrink_to_fit(), 0);
+    EXPECT_EQ(ob.capacity(), 1);
+    EXPECT_EQ(ob.len(), 1);
+    EXPECT_IS(ob[0], Py_None);
+
+    ASSERT_EQ(PyList_SetSlice(ob, 0, 1, nullptr), 0);
+    ASSERT_EQ(ob.shrink_to_fit(), 0);
+    EXPECT_EQ(ob.capacity(), 0);
+    EXPECT_EQ(ob.len(), 0);
+}
+
+TEST(List, extend_sequence) {
+    py::tmpref<py::list::object> ob(PyList_New(0));
+    py::tmpref<py::object> item(PyLong_FromLong(12345));
+    Py_ssize_t refcnt = Py_REFCNT(item);
+
+    py::tmpref<py::object> tuple(PyTuple_Pack(2, Py_None,
+                                              static_cast<PyObject*>(item)));
+    ASSERT_EQ(ob.extend(tuple), 0);
+    ASSERT_EQ(ob.len(), 2);
+    EXPECT_IS(ob[0], Py_None);
+    EXPECT_IS(ob[1], item);
+    EXPECT_EQ(Py_REFCNT(item), refcnt + 2);
+
+    // extending a list with itself copies the original elements
+    ASSERT_EQ(ob.extend(ob), 0);
+    ASSERT_EQ(ob.len(), 4);
+    EXPECT_IS(ob[2], Py_None);
+    EXPECT_IS(ob[3], item);
+    EXPECT_EQ(Py_REFCNT(item), refcnt + 3);
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST(List, extend_iterable) {
+    auto array = eval("array.array('l', [1, 2, 3])");
+    ASSERT_TRUE(array.is_nonnull());
+
+    py::tmpref<py::list::object> ob(PyList_New(0));
+    ASSERT_EQ(ob.extend(array), 0);
+    ASSERT_EQ(ob.len(), 3);
+    EXPECT_EQ(ob.capacity(), 3);
+    EXPECT_EQ(PyLong_AsLong(ob[2]), 3);
+
+    EXPECT_EQ(ob.extend(Py_None), -1);
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+}
+
+TEST(List, extend_range) {
+    py::tmpref<py::list::object> ob(PyList_New(0));
+    ASSERT_EQ(ob.append(py::object(Py_None)), 0);
+
+    std::vector<long> values = {1, 2, 3};
+    ASSERT_EQ(ob.extend(values), 0);
+    ASSERT_EQ(ob.len(), 4);
+    EXPECT_IS(ob[0], Py_None);
+    EXPECT_EQ(PyLong_AsLong(ob[3]), 3);
+
+    std::array<double, 2> doubles = {0.5, 1.5};
+    ASSERT_EQ(ob.extend(doubles.begin(), doubles.end()), 0);
+    ASSERT_EQ(ob.len(), 6);
+    EXPECT_EQ(PyFloat_AsDouble(ob[5]), 1.5);
+    EXPECT_NO_PYTHON_ERR();
+
+    std::vector<std::string> strings = {"a", "\xff"};
+    EXPECT_EQ(ob.extend(strings), -1);
+    EXPECT_PYTHON_ERR(PyExc_UnicodeDecodeError);
+    // elements before the failure are kept
+    EXPECT_EQ(ob.len(), 7);
+}
+
+TEST(List, extend_input_iterator) {
+    py::tmpref<py::list::object> ob(PyList_New(0));
+    ASSERT_EQ(ob.append(py::object(Py_None)), 0);
+
+    // a generator is only traversed once
+    auto gen = eval("(n for n in range(3))");
+    ASSERT_TRUE(gen.is_nonnull());
+    ASSERT_EQ(ob.extend(gen.begin(), gen.end()), 0);
+    EXPECT_TRUE((ob == eval("[None, 0, 1, 2]")).istrue());
+    EXPECT_NO_PYTHON_ERR();
+
+    auto failing = eval("(1 // n for n in (1, 0))");
+    ASSERT_TRUE(failing.is_nonnull());
+    EXPECT_EQ(ob.extend(failing.begin(), failing.end()), -1);
+    EXPECT_PYTHON_ERR(PyExc_ZeroDivisionError);
+    EXPECT_EQ(ob.len(), 5);
+}
+
+TEST(List, extend_subclass) {
+    auto ns = make_namespace();
+    ASSERT_TRUE(ns.is_nonnull());
+    ASSERT_EQ(exec("class L(list):\n"
+                   "    def __iter__(self):\n"
+                   "        return iter([-1])\n",
+                   ns),
+              0);
+    auto sub = eval("L([1, 2, 3])", ns);
+    ASSERT_TRUE(sub.is_nonnull());
+
+    // the override is used instead of copying the storage
+    py::tmpref<py::list::object> ob(PyList_New(0));
+    ASSERT_EQ(ob.extend(sub), 0);
+    ASSERT_EQ(ob.len(), 1);
+    EXPECT_EQ(PyLong_AsLong(ob[0]), -1);
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST(List, extend_pending_error) {
+    py::tmpref<py::object> range(PyObject_CallFunction(
+        reinterpret_cast<PyObject*>(&PyRange_Type), "i", 3));
+    ASSERT_TRUE(range.is_nonnull());
+
+    // an exception which was already pending is not reported as a failure
+    // and is left in place
+    PyErr_SetString(PyExc_ValueError, "pending");
+    py::tmpref<py::list::object> ob(PyList_New(0));
+    EXPECT_EQ(ob.extend(range), 0);
+    EXPECT_EQ(ob.len(), 3);
+    EXPECT_PYTHON_ERR(PyExc_ValueError);
+}
@@ -9,6 +9,7 @@
 #include "utils.h"
 
 using py::operator""_p;
+using py::operator""_kw;
 
 TEST(Layout, py_object) {
     EXPECT_TRUE(std::is_standard_layout<py::object>::value);
@@ -102,3 +103,230 @@ TEST_F(Object, setattr_delattr) {
     ASSERT_EQ(this->C.delattr("test"_p), 0);
     EXPECT_FALSE(this->C.hasattr("test"_p));
 }
+
+TEST_F(Object, call) {
+    auto f = eval("lambda *args: args");
+    ASSERT_TRUE(f.is_nonnull());
+
+    EXPECT_TRUE((f() == py::tuple::pack()).istrue());
+    EXPECT_TRUE((f(1_p) == py::tuple::pack(1_p)).istrue());
+    EXPECT_TRUE((f(1_p, "a"_p, 2.5_p) ==
+                 py::tuple::pack(1_p, "a"_p, 2.5_p)).istrue());
+    EXPECT_NO_PYTHON_ERR();
+
+    auto result = f(1_p, 2_p);
+    EXPECT_EQ(result.refcnt(), 1);
+}
+
+TEST_F(Object, call_bound_method) {
+    auto f = eval("lambda self, a, b: (self, a, b)");
+    ASSERT_EQ(this->C.setattr("f"_p, f), 0);
+
+    auto instance = this->C();
+    ASSERT_TRUE(instance.is_nonnull());
+
+    auto result = instance.getattr("f"_p)(1_p, 2_p);
+    EXPECT_TRUE((result == py::tuple::pack(instance, 1_p, 2_p)).istrue());
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST_F(Object, call_nullptr) {
+    EXPECT_IS(py::object(nullptr)(1_p), nullptr);
+    EXPECT_PYTHON_ERR(PyExc_AssertionError);
+
+    EXPECT_IS(this->C(py::object(nullptr)), nullptr);
+    EXPECT_PYTHON_ERR(PyExc_AssertionError);
+}
+
+TEST_F(Object, call_kwargs) {
+    auto f = eval("lambda *args, **kwargs: (args, sorted(kwargs.items()))");
+    ASSERT_TRUE(f.is_nonnull());
+
+    auto expected = eval("((1,), [('a', 2), ('b', 3)])");
+    ASSERT_TRUE(expected.is_nonnull());
+
+    for (int n = 0; n < 2; ++n) {
+        auto result = f(1_p, "b"_kw = 3_p, "a"_kw = 2_p);
+        EXPECT_TRUE((result == expected).istrue());
+        EXPECT_NO_PYTHON_ERR();
+    }
+
+    auto empty = f("a"_kw = 2_p);
+    EXPECT_TRUE((empty.getitem(0_p) == py::tuple::pack()).istrue());
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST_F(Object, call_keyword_only) {
+    auto f = eval("lambda a, *, b: (a, b)");
+    ASSERT_TRUE(f.is_nonnull());
+
+    auto result = f(1_p, "b"_kw = 2_p);
+    EXPECT_TRUE((result == py::tuple::pack(1_p, 2_p)).istrue());
+
+    EXPECT_IS(f(1_p, 2_p), nullptr);
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    EXPECT_IS(f(1_p, "b"_kw = py::object(nullptr)), nullptr);
+    EXPECT_PYTHON_ERR(PyExc_AssertionError);
+}
+
+TEST_F(Object, call_method) {
+    auto result = "ayy.lmao"_p.call_method("find"_p, "."_p);
+    EXPECT_TRUE((result == 3_p).istrue());
+    EXPECT_NO_PYTHON_ERR();
+
+    auto split = "a,b"_p.call_method("split"_p, "sep"_kw = ","_p);
+    EXPECT_TRUE((split == py::list::pack("a"_p, "b"_p)).istrue());
+    EXPECT_NO_PYTHON_ERR();
+
+    EXPECT_IS("ayy.lmao"_p.call_method("invalid"_p), nullptr);
+    EXPECT_PYTHON_ERR(PyExc_AttributeError);
+
+    EXPECT_IS("ayy.lmao"_p.call_method(py::object(nullptr)), nullptr);
+    EXPECT_PYTHON_ERR(PyExc_AssertionError);
+}
+
+TEST_F(Object, call_method_python_function) {
+    auto f = eval("lambda self, a, *, b: (self, a, b)");
+    ASSERT_EQ(this->C.setattr("f"_p, f), 0);
+
+    auto instance = this->C();
+    ASSERT_TRUE(instance.is_nonnull());
+
+    auto result = instance.call_method("f"_p, 1_p, "b"_kw = 2_p);
+    EXPECT_TRUE((result == py::tuple::pack(instance, 1_p, 2_p)).istrue());
+    EXPECT_NO_PYTHON_ERR();
+
+    // attributes in the instance dict are not bound
+    ASSERT_EQ(instance.setattr("g"_p, f), 0);
+    result = instance.call_method("g"_p, 1_p, 2_p, "b"_kw = 3_p);
+    EXPECT_TRUE((result == py::tuple::pack(1_p, 2_p, 3_p)).istrue());
+    EXPECT_NO_PYTHON_ERR();
+}
+
+namespace {
+py::tmpref<py::object> collect(py::object ob) {
+    py::tmpref<py::object> out(PyList_New(0));
+    for (const auto &item : ob) {
+        if (PyList_Append(out, item)) {
+            return nullptr;
+        }
+    }
+    return out;
+}
+}
+
+TEST_F(Object, iterate) {
+    auto expected = py::list::pack(1_p, 2_p, 3_p);
+    for (const char *expr : {"[1, 2, 3]",
+                             "(1, 2, 3)",
+                             "{1: 'a', 2: 'b', 3: 'c'}",
+                             "range(1, 4)",
+                             "iter([1, 2, 3])",
+                             "type('L', (list,), {})([1, 2, 3])",
+                             "(n for n in (1, 2, 3))"}) {
+        auto ob = eval(expr);
+        ASSERT_TRUE(ob.is_nonnull()) << expr;
+        auto items = collect(ob);
+        EXPECT_NO_PYTHON_ERR();
+        EXPECT_TRUE((items == expected).istrue()) << expr;
+    }
+
+    for (const char *expr : {"[]", "()", "{}", "iter(())"}) {
+        auto ob = eval(expr);
+        ASSERT_TRUE(ob.is_nonnull()) << expr;
+        EXPECT_EQ(ob.begin(), ob.end()) << expr;
+        EXPECT_NO_PYTHON_ERR();
+    }
+}
+
+TEST_F(Object, iterate_borrowed) {
+    auto list = py::list::pack(1_p, 2_p);
+    Py_ssize_t refcnt = Py_REFCNT(static_cast<PyObject*>(1_p));
+    auto it = py::object(list).begin();
+    EXPECT_IS(*it, 1_p);
+    // the item is borrowed from the list
+    EXPECT_EQ(Py_REFCNT(static_cast<PyObject*>(1_p)), refcnt);
+    ++it;
+    EXPECT_IS(*it, 2_p);
+    ++it;
+    EXPECT_EQ(it, py::object(list).end());
+}
+
+TEST_F(Object, iterate_list_shrinks) {
+    auto list = py::list::pack(1_p, 2_p, 3_p);
+    std::size_t seen = 0;
+    for (const auto &item : py::object(list)) {
+        (void) item;
+        ++seen;
+        PySequence_DelItem(list, -1);
+    }
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_EQ(seen, 2u);
+}
+
+TEST_F(Object, iterate_dict_changed_size) {
+    auto dict = eval("{1: 'a', 2: 'b'}");
+    ASSERT_TRUE(dict.is_nonnull());
+    for (const auto &key : py::object(dict)) {
+        (void) key;
+        PyDict_SetItem(dict, 3_p, 3_p);
+    }
+    EXPECT_PYTHON_ERR(PyExc_RuntimeError);
+}
+
+TEST_F(Object, iterate_error) {
+    auto gen = eval("(1 // n for n in (1, 0, 1))");
+    ASSERT_TRUE(gen.is_nonnull());
+    std::size_t seen = 0;
+    for (const auto &item : py::object(gen)) {
+        (void) item;
+        ++seen;
+    }
+    EXPECT_EQ(seen, 1u);
+    EXPECT_PYTHON_ERR(PyExc_ZeroDivisionError);
+}
+
+TEST_F(Object, iterate_nullptr) {
+    py::object ob(nullptr);
+    EXPECT_EQ(ob.begin(), ob.end());
+    EXPECT_PYTHON_ERR(PyExc_AssertionError);
+}
+
+TEST_F(Object, next_batch) {
+    auto it = eval("iter(range(5))");
+    ASSERT_TRUE(it.is_nonnull());
+
+    PyObject *buffer[3];
+    EXPECT_EQ(it.next_batch(buffer, 3), 3);
+    EXPECT_NO_PYTHON_ERR();
+    for (Py_ssize_t n = 0; n < 3; ++n) {
+        EXPECT_EQ(PyLong_AsLong(buffer[n]), n);
+        Py_DECREF(buffer[n]);
+    }
+
+    EXPECT_EQ(it.next_batch(buffer, 3), 2);
+    EXPECT_NO_PYTHON_ERR();
+    for (Py_ssize_t n = 0; n < 2; ++n) {
+        EXPECT_EQ(PyLong_AsLong(buffer[n]), n + 3);
+        Py_DECREF(buffer[n]);
+    }
+
+    EXPECT_EQ(it.next_batch(buffer, 3), 0);
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST_F(Object, next_batch_error) {
+    auto gen = eval("(1 // n for n in (1, 0, 1))");
+    ASSERT_TRUE(gen.is_nonnull());
+
+    PyObject *buffer[3];
+    EXPECT_EQ(gen.next_batch(buffer, 3), -1);
+    EXPECT_PYTHON_ERR(PyExc_ZeroDivisionError);
+
+    EXPECT_EQ(py::object(1_p).next_batch(buffer, 3), -1);
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    EXPECT_EQ(py::object(nullptr).next_batch(buffer, 3), -1);
+    EXPECT_PYTHON_ERR(PyExc_AssertionError);
+}
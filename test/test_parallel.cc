@@ -0,0 +1,137 @@
+#include <atomic>
+#include <stdexcept>
+
+#include "gtest/gtest.h"
+#include <Python.h>
+
+#include "libpy/libpy.h"
+#include "utils.h"
+
+using py::operator""_p;
+
+namespace {
+long square(long n) {
+    return n * n;
+}
+
+/**
+   Run the tests with several threads even on a single core machine so
+   that the pool is exercised.
+*/
+class Parallel : public testing::Test {
+protected:
+    std::size_t saved;
+
+    virtual void SetUp() {
+        saved = pyutils::parallel_threads();
+        pyutils::set_parallel_threads(4);
+    }
+
+    virtual void TearDown() {
+        pyutils::set_parallel_threads(saved);
+    }
+};
+}
+
+TEST_F(Parallel, list) {
+    auto values = eval("list(range(100000))");
+    ASSERT_TRUE(values.is_nonnull());
+
+    auto result = py::parallel_transform(values, square);
+    ASSERT_TRUE(result.is_nonnull());
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == eval("[n * n for n in range(100000)]")).istrue());
+}
+
+TEST_F(Parallel, tuple) {
+    auto values = eval("tuple(range(10))");
+    ASSERT_TRUE(values.is_nonnull());
+
+    auto result = py::parallel_transform(values,
+                                         [](double x) { return x / 2; },
+                                         3);
+    ASSERT_TRUE(result.is_nonnull());
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == eval("[n / 2 for n in range(10)]")).istrue());
+}
+
+TEST_F(Parallel, buffer) {
+    auto values = eval("array.array('d', range(1000))");
+    ASSERT_TRUE(values.is_nonnull());
+
+    auto result = py::parallel_transform<double>(
+        values,
+        [](double x) { return x > 500; },
+        16);
+    ASSERT_TRUE(result.is_nonnull());
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == eval("[n > 500 for n in range(1000)]")).istrue());
+}
+
+TEST_F(Parallel, releases_gil) {
+    auto values = eval("list(range(64))");
+    ASSERT_TRUE(values.is_nonnull());
+
+    auto result = py::parallel_transform(
+        values,
+        [](long) { return static_cast<bool>(PyGILState_Check()); },
+        1);
+    ASSERT_TRUE(result.is_nonnull());
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == eval("[False] * 64")).istrue());
+}
+
+TEST_F(Parallel, empty) {
+    auto result = py::parallel_transform(eval("[]"), square);
+    ASSERT_TRUE(result.is_nonnull());
+    EXPECT_EQ(result.len(), 0);
+}
+
+TEST_F(Parallel, errors) {
+    EXPECT_FALSE(py::parallel_transform(eval("[1, 'a']"), square).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    EXPECT_FALSE(py::parallel_transform(1_p, square).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    auto result = py::parallel_transform(
+        eval("list(range(100))"),
+        [](long n) {
+            if (n == 50) {
+                throw std::runtime_error("bad value");
+            }
+            return n;
+        },
+        10);
+    EXPECT_FALSE(result.is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_RuntimeError);
+}
+
+TEST_F(Parallel, nested) {
+    // running a parallel loop from inside one runs it serially
+    std::atomic<long> total{0};
+    auto exc = pyutils::_parallel_for(8, 1, [&](std::size_t, std::size_t) {
+            // each outer block is one item
+            auto inner = pyutils::_parallel_for(
+                4,
+                1,
+                [&](std::size_t begin, std::size_t end) {
+                    total += end - begin;
+                });
+            EXPECT_FALSE(inner);
+        });
+    EXPECT_FALSE(exc);
+    EXPECT_EQ(total.load(), 32);
+}
+
+TEST_F(Parallel, threads) {
+    pyutils::set_parallel_threads(0);
+    EXPECT_EQ(pyutils::parallel_threads(), 1u);
+    auto result = py::parallel_transform(eval("[1, 2, 3]"), square, 1);
+    EXPECT_TRUE((result == eval("[1, 4, 9]")).istrue());
+
+    pyutils::set_parallel_threads(2);
+    EXPECT_EQ(pyutils::parallel_threads(), 2u);
+    result = py::parallel_transform(eval("[1, 2, 3]"), square, 1);
+    EXPECT_TRUE((result == eval("[1, 4, 9]")).istrue());
+}
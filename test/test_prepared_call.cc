@@ -0,0 +1,126 @@
+#include "gtest/gtest.h"
+#include <Python.h>
+
+#include "libpy/libpy.h"
+#include "utils.h"
+
+using py::operator""_p;
+
+namespace {
+PyObject *return_args(PyObject*, PyObject *args) {
+    Py_INCREF(args);
+    return args;
+}
+
+PyMethodDef return_args_def = {
+    "return_args",
+    return_args,
+    METH_VARARGS,
+    nullptr,
+};
+
+py::prepared_call<1> *recursive_call = nullptr;
+
+struct recurse {};
+
+/**
+   `tp_call` which calls `recursive_call` again with one less than its
+   argument and then reads its own argument.
+*/
+PyObject *recurse_call(PyObject*, PyObject *args, PyObject*) {
+    long depth = PyLong_AsLong(PyTuple_GET_ITEM(args, 0));
+    if (depth > 0) {
+        py::tmpref<py::object> next(PyLong_FromLong(depth - 1));
+        if (!next.is_nonnull() ||
+            !recursive_call->invoke(next).is_nonnull()) {
+            return nullptr;
+        }
+    }
+    PyObject *out = PyTuple_GET_ITEM(args, 0);
+    if (!out) {
+        PyErr_SetString(PyExc_AssertionError, "arguments were cleared");
+        return nullptr;
+    }
+    Py_INCREF(out);
+    return out;
+}
+}
+
+TEST(PreparedCall, function) {
+    auto f = eval("lambda a, b: (a, b)");
+    ASSERT_TRUE(f.is_nonnull());
+
+    py::prepared_call<2> call(f);
+    for (int n = 0; n < 3; ++n) {
+        auto result = call.invoke(1_p, "a"_p);
+        EXPECT_TRUE((result == py::tuple::pack(1_p, "a"_p)).istrue());
+        EXPECT_NO_PYTHON_ERR();
+    }
+}
+
+TEST(PreparedCall, tp_call) {
+    auto result = eval(
+        "type('Callable', (), {'__call__': lambda self, a: a})()");
+    ASSERT_TRUE(result.is_nonnull());
+
+    py::prepared_call<1> call(result);
+    for (const auto &ob : {1_p, 2_p, 3_p}) {
+        EXPECT_IS(call.invoke(ob), ob);
+        EXPECT_NO_PYTHON_ERR();
+    }
+}
+
+TEST(PreparedCall, callee_keeps_args) {
+    auto f = function(return_args_def);
+    ASSERT_TRUE(f.is_nonnull());
+
+    py::prepared_call<2> call(f);
+    auto a = call.invoke(1_p, 2_p);
+    auto b = call.invoke(3_p, 4_p);
+    EXPECT_TRUE((a == py::tuple::pack(1_p, 2_p)).istrue());
+    EXPECT_TRUE((b == py::tuple::pack(3_p, 4_p)).istrue());
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST(PreparedCall, reentrant) {
+    auto type = py::type::builder<recurse>("test.recurse")
+        .slot(Py_tp_call, reinterpret_cast<void*>(recurse_call))
+        .create();
+    ASSERT_TRUE(type.is_nonnull());
+    auto f = type();
+    ASSERT_TRUE(f.is_nonnull());
+
+    py::prepared_call<1> call(f);
+    recursive_call = &call;
+    for (int n = 0; n < 2; ++n) {
+        auto result = call.invoke(3_p);
+        EXPECT_NO_PYTHON_ERR();
+        EXPECT_TRUE((result == 3_p).istrue());
+    }
+    recursive_call = nullptr;
+}
+
+TEST(PreparedCall, no_args) {
+    auto f = eval("lambda: 1");
+    ASSERT_TRUE(f.is_nonnull());
+
+    py::prepared_call<0> call(f);
+    EXPECT_TRUE((call.invoke() == 1_p).istrue());
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST(PreparedCall, errors) {
+    auto f = eval("lambda a: 1 / a");
+    ASSERT_TRUE(f.is_nonnull());
+
+    py::prepared_call<1> call(f);
+    EXPECT_IS(call.invoke(0_p), nullptr);
+    EXPECT_PYTHON_ERR(PyExc_ZeroDivisionError);
+
+    EXPECT_IS(call.invoke(py::object(nullptr)), nullptr);
+    EXPECT_PYTHON_ERR(PyExc_AssertionError);
+
+    py::prepared_call<1> null_call(nullptr);
+    EXPECT_IS(null_call.invoke(1_p), nullptr);
+    EXPECT_PYTHON_ERR(PyExc_AssertionError);
+}
@@ -5,7 +5,7 @@
 using py::operator""_p;
 
 py::tmpref<py::object> f() {
-    return "ayy.lmao"_p.getattr("find"_p)("."_p) + 1_p + 2.5_p;
+    return "ayy.lmao"_p.call_method("find"_p, "."_p) + 1_p + 2.5_p;
 }
 
 TEST(ReadMe, example) {
@@ -0,0 +1,190 @@
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include <Python.h>
+
+#include "libpy/libpy.h"
+#include "utils.h"
+
+using py::operator""_p;
+
+TEST(Set, type) {
+    ASSERT_EQ(static_cast<PyObject*>(py::set::type),
+              reinterpret_cast<PyObject*>(&PySet_Type));
+    ASSERT_EQ(static_cast<PyObject*>(py::set::frozenset_type),
+              reinterpret_cast<PyObject*>(&PyFrozenSet_Type));
+
+    auto s = py::set::type();
+    EXPECT_EQ(static_cast<PyObject*>(s.type()),
+              reinterpret_cast<PyObject*>(&PySet_Type));
+    EXPECT_EQ(s.len(), 0);
+}
+
+TEST(Set, check) {
+    py::tmpref<py::object> s(PySet_New(nullptr));
+    py::tmpref<py::object> f(PyFrozenSet_New(nullptr));
+    EXPECT_EQ(py::set::check(s), 1);
+    EXPECT_EQ(py::set::check(f), 1);
+    EXPECT_EQ(py::set::checkexact(f), 1);
+    EXPECT_EQ(py::set::check(1_p), 0);
+
+    py::set::object frozen(f);
+    EXPECT_TRUE(frozen.is_nonnull());
+
+    py::set::object not_set(1_p);
+    EXPECT_FALSE(not_set.is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+}
+
+TEST(Set, add_contains_discard) {
+    py::tmpref<py::set::object> s(PySet_New(nullptr));
+    ASSERT_TRUE(s.is_nonnull());
+
+    ASSERT_EQ(s.add(1_p), 0);
+    EXPECT_EQ(s.len(), 1);
+    EXPECT_EQ(s.contains(1_p), 1);
+    EXPECT_EQ(s.contains(2_p), 0);
+
+    EXPECT_EQ(s.discard(1_p), 1);
+    EXPECT_EQ(s.discard(1_p), 0);
+    EXPECT_EQ(s.len(), 0);
+    EXPECT_NO_PYTHON_ERR();
+
+    py::tmpref<py::object> unhashable(PyList_New(0));
+    EXPECT_EQ(s.contains(unhashable), -1);
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+}
+
+TEST(Set, contains_many) {
+    std::vector<long> members = {1, 3, 5};
+    auto s = py::set::from_range(members);
+    ASSERT_TRUE(s.is_nonnull());
+    EXPECT_EQ(s.len(), 3);
+
+    std::vector<long> probes = {0, 1, 2, 3, 4, 5};
+    std::vector<bool> found;
+    ASSERT_EQ(s.contains_many(probes, found), 0);
+    EXPECT_EQ(found,
+              std::vector<bool>({false, true, false, true, false, true}));
+
+    // Python sequences are ranges of objects
+    auto list = py::list::pack(1_p, 2_p);
+    ASSERT_EQ(s.contains_many(list, found), 0);
+    EXPECT_EQ(found, std::vector<bool>({true, false}));
+    std::move(list).invalidate();
+    EXPECT_NO_PYTHON_ERR();
+
+    std::vector<std::string> bad = {"\xff"};
+    EXPECT_EQ(s.contains_many(bad, found), -1);
+    EXPECT_PYTHON_ERR(PyExc_UnicodeDecodeError);
+}
+
+TEST(Set, update) {
+    py::tmpref<py::set::object> s(PySet_New(nullptr));
+
+    std::vector<long> values = {1, 2, 2, 3};
+    ASSERT_EQ(s.update(values), 0);
+    EXPECT_EQ(s.len(), 3);
+
+    py::tmpref<py::object> tuple(PyTuple_Pack(2,
+                                              static_cast<PyObject*>(3_p),
+                                              static_cast<PyObject*>(4_p)));
+    ASSERT_EQ(s.update(tuple), 0);
+    EXPECT_EQ(s.len(), 4);
+    EXPECT_EQ(s.contains(4_p), 1);
+    EXPECT_NO_PYTHON_ERR();
+
+    EXPECT_EQ(s.update(1_p), -1);
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+}
+
+TEST(Set, difference_update) {
+    std::vector<long> values = {1, 2, 3, 4};
+    auto s = py::set::from_range(values);
+    ASSERT_TRUE(s.is_nonnull());
+
+    std::vector<long> remove = {1, 5};
+    ASSERT_EQ(s.difference_update(remove), 0);
+    EXPECT_EQ(s.len(), 3);
+    EXPECT_EQ(s.contains(1_p), 0);
+
+    py::tmpref<py::object> tuple(PyTuple_Pack(1,
+                                              static_cast<PyObject*>(2_p)));
+    ASSERT_EQ(s.difference_update(tuple), 0);
+    EXPECT_EQ(s.len(), 2);
+
+    ASSERT_EQ(s.difference_update(s), 0);
+    EXPECT_EQ(s.len(), 0);
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST(Set, generator) {
+    auto gen = [] {
+        return eval("(x for x in [1, 2, 7])");
+    };
+
+    std::vector<long> members = {1, 7};
+    auto s = py::set::from_range(members);
+    ASSERT_TRUE(s.is_nonnull());
+
+    // the generator is only consumed once, while probing
+    std::vector<bool> found;
+    ASSERT_EQ(s.contains_many(gen(), found), 0);
+    EXPECT_EQ(found, std::vector<bool>({true, false, true}));
+
+    auto values = gen();
+    auto from_gen = py::set::from_range(values.begin(), values.end());
+    ASSERT_TRUE(from_gen.is_nonnull());
+    EXPECT_EQ(from_gen.len(), 3);
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST(Set, difference_update_pending_error) {
+    std::vector<long> values = {0, 1, 5};
+    auto s = py::set::from_range(values);
+    py::tmpref<py::object> range(PyObject_CallFunction(
+        reinterpret_cast<PyObject*>(&PyRange_Type), "i", 3));
+    ASSERT_TRUE(range.is_nonnull());
+
+    PyErr_SetString(PyExc_ValueError, "pending");
+    EXPECT_EQ(s.difference_update(range), 0);
+    EXPECT_EQ(s.len(), 1);
+    EXPECT_PYTHON_ERR(PyExc_ValueError);
+}
+
+TEST(Set, input_iterator_pending_error) {
+    std::vector<long> members = {1};
+    auto s = py::set::from_range(members);
+    ASSERT_TRUE(s.is_nonnull());
+
+    // an exception which was already pending is not reported as a failure
+    // of the iteration, and it is still pending afterwards
+    auto values = eval("(x for x in [1, 2, 7])");
+    ASSERT_TRUE(values.is_nonnull());
+    auto first = values.begin();
+    auto last = values.end();
+    PyErr_SetString(PyExc_ValueError, "pending");
+    EXPECT_EQ(s.update(first, last), 0);
+    EXPECT_PYTHON_ERR(PyExc_ValueError);
+    EXPECT_EQ(s.len(), 3);
+
+    values = eval("(x for x in [2, 5])");
+    ASSERT_TRUE(values.is_nonnull());
+    std::vector<bool> found;
+    first = values.begin();
+    last = values.end();
+    PyErr_SetString(PyExc_ValueError, "pending");
+    EXPECT_EQ(s.contains_many(first, last, found), 0);
+    EXPECT_PYTHON_ERR(PyExc_ValueError);
+    EXPECT_EQ(found, std::vector<bool>({true, false}));
+
+    values = eval("(x for x in [1, 2])");
+    ASSERT_TRUE(values.is_nonnull());
+    first = values.begin();
+    last = values.end();
+    PyErr_SetString(PyExc_ValueError, "pending");
+    EXPECT_EQ(s.difference_update(first, last), 0);
+    EXPECT_PYTHON_ERR(PyExc_ValueError);
+    EXPECT_EQ(s.len(), 1);
+}
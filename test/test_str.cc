@@ -0,0 +1,93 @@
+#include <string>
+
+#include "gtest/gtest.h"
+#include <Python.h>
+
+#include "libpy/libpy.h"
+#include "utils.h"
+
+using py::operator""_p;
+
+TEST(Str, type) {
+    ASSERT_EQ(static_cast<PyObject*>(py::str::type),
+              reinterpret_cast<PyObject*>(&PyUnicode_Type));
+
+    auto s = py::str::type();
+    EXPECT_EQ(static_cast<PyObject*>(s.type()),
+              reinterpret_cast<PyObject*>(&PyUnicode_Type));
+    EXPECT_EQ(s.len(), 0);
+}
+
+TEST(Str, check) {
+    py::tmpref<py::object> s(PyUnicode_FromString("abc"));
+    EXPECT_EQ(py::str::check(s), 1);
+    EXPECT_EQ(py::str::checkexact(s), 1);
+    EXPECT_EQ(py::str::check(1_p), 0);
+
+    py::str::object not_str(1_p);
+    EXPECT_FALSE(not_str.is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+}
+
+TEST(Str, ascii) {
+    py::tmpref<py::str::object> s(PyUnicode_FromString("abc"));
+    ASSERT_TRUE(s.is_nonnull());
+
+    EXPECT_EQ(s.len(), 3);
+    EXPECT_EQ(s.is_ascii(), 1);
+    EXPECT_EQ(s.kind(), PyUnicode_1BYTE_KIND);
+
+    py::str::string_view view = s.utf8();
+    EXPECT_EQ(std::string(view.data(), view.size()), "abc");
+    // ASCII views point at the string's storage
+    EXPECT_EQ(static_cast<const void*>(view.data()), s.data());
+
+    auto nonnull = s.as_nonnull();
+    EXPECT_EQ(nonnull.utf8().data(), view.data());
+
+    ASSERT_NE(s.ucs1(), nullptr);
+    EXPECT_EQ(s.ucs1()[2], 'c');
+    EXPECT_EQ(s.ucs2(), nullptr);
+    EXPECT_PYTHON_ERR(PyExc_ValueError);
+}
+
+TEST(Str, kinds) {
+    py::tmpref<py::str::object> latin1(PyUnicode_FromString("caf\xc3\xa9"));
+    ASSERT_TRUE(latin1.is_nonnull());
+    EXPECT_EQ(latin1.is_ascii(), 0);
+    EXPECT_EQ(latin1.kind(), PyUnicode_1BYTE_KIND);
+    EXPECT_EQ(latin1.ucs1()[3], 0xe9);
+
+    py::str::string_view view = latin1.utf8();
+    EXPECT_EQ(std::string(view.data(), view.size()), "caf\xc3\xa9");
+    // the encoding is cached so a second view shares the buffer
+    EXPECT_EQ(latin1.utf8().data(), view.data());
+
+    py::tmpref<py::str::object> ucs2(PyUnicode_FromString("\xe2\x82\xac"));
+    EXPECT_EQ(ucs2.kind(), PyUnicode_2BYTE_KIND);
+    EXPECT_EQ(ucs2.ucs2()[0], 0x20ac);
+
+    py::tmpref<py::str::object> ucs4(PyUnicode_FromString("\xf0\x9f\x98\x80"));
+    EXPECT_EQ(ucs4.kind(), PyUnicode_4BYTE_KIND);
+    EXPECT_EQ(ucs4.len(), 1);
+    EXPECT_EQ(ucs4.ucs4()[0], 0x1f600u);
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST(Str, utf8_error) {
+    Py_UCS4 surrogate = 0xd800;
+    py::tmpref<py::str::object> s(
+        PyUnicode_FromKindAndData(PyUnicode_4BYTE_KIND, &surrogate, 1));
+    ASSERT_TRUE(s.is_nonnull());
+    EXPECT_EQ(s.utf8().data(), nullptr);
+    EXPECT_PYTHON_ERR(PyExc_UnicodeEncodeError);
+}
+
+TEST(Str, hash) {
+    py::tmpref<py::str::object> s(PyUnicode_FromString("key"));
+    py::hash_t hash = s.hash();
+    EXPECT_NE(hash, -1);
+    EXPECT_EQ(hash, PyObject_Hash(s));
+    // the second call reads the cached hash
+    EXPECT_EQ(s.hash(), hash);
+}
@@ -0,0 +1,106 @@
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include "gtest/gtest.h"
+#include <Python.h>
+
+#include "libpy/libpy.h"
+#include "utils.h"
+
+using py::operator""_p;
+
+TEST(ToPython, bool_) {
+    py::tmpref<py::object> t(pyutils::to_python(true));
+    EXPECT_IS(t, Py_True);
+
+    py::tmpref<py::object> f(pyutils::to_python(false));
+    EXPECT_IS(f, Py_False);
+}
+
+TEST(ToPython, integral) {
+    py::tmpref<py::object> small(pyutils::to_python(5));
+    EXPECT_TRUE((small == 5_p).istrue());
+
+    // small ints come from the cache
+    py::tmpref<py::object> again(pyutils::to_python(static_cast<short>(5)));
+    EXPECT_IS(small, again);
+
+    py::tmpref<py::object> max(pyutils::to_python(
+                                   std::numeric_limits<std::uint64_t>::max()));
+    py::tmpref<py::object> expected(
+        PyLong_FromUnsignedLongLong(
+            std::numeric_limits<unsigned long long>::max()));
+    EXPECT_TRUE((max == expected).istrue());
+
+    py::tmpref<py::object> min(pyutils::to_python(
+                                   std::numeric_limits<std::int64_t>::min()));
+    py::tmpref<py::object> expected_min(
+        PyLong_FromLongLong(std::numeric_limits<long long>::min()));
+    EXPECT_TRUE((min == expected_min).istrue());
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST(ToPython, floating) {
+    py::tmpref<py::object> d(pyutils::to_python(1.5));
+    EXPECT_TRUE(PyFloat_CheckExact(static_cast<PyObject*>(d)));
+    EXPECT_TRUE((d == 1.5_p).istrue());
+
+    py::tmpref<py::object> f(pyutils::to_python(2.5f));
+    EXPECT_TRUE((f == 2.5_p).istrue());
+}
+
+TEST(ToPython, string) {
+    std::string s("ayy\0lmao", 8);
+    py::tmpref<py::object> ob(pyutils::to_python(s));
+    ASSERT_TRUE(ob.is_nonnull());
+    EXPECT_EQ(PyUnicode_GET_LENGTH(static_cast<PyObject*>(ob)), 8);
+
+    py::tmpref<py::object> c(pyutils::to_python("ayy"));
+    EXPECT_TRUE((c == "ayy"_p).istrue());
+}
+
+TEST(ToPython, tuple) {
+    py::tmpref<py::object> p(pyutils::to_python(std::make_pair(1, 2.5)));
+    EXPECT_TRUE((p == py::tuple::pack(1_p, 2.5_p)).istrue());
+
+    py::tmpref<py::object> t(pyutils::to_python(
+                                 std::make_tuple(true, std::string("a"), 3)));
+    EXPECT_TRUE((t == py::tuple::pack(py::True, "a"_p, 3_p)).istrue());
+
+    py::tmpref<py::object> empty(pyutils::to_python(std::tuple<>{}));
+    ASSERT_TRUE(empty.is_nonnull());
+    EXPECT_EQ(PyTuple_GET_SIZE(static_cast<PyObject*>(empty)), 0);
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST(ToPython, wrappers) {
+    py::object ob = "ayy"_p;
+    Py_ssize_t start = Py_REFCNT(ob);
+
+    {
+        py::tmpref<py::object> out(pyutils::to_python(ob));
+        EXPECT_IS(out, ob);
+        EXPECT_EQ(Py_REFCNT(ob), start + 1);
+    }
+    EXPECT_EQ(Py_REFCNT(ob), start);
+
+    // rvalue tmprefs give up their reference
+    py::tmpref<py::object> owned(PyUnicode_FromString("ayy lmao"));
+    PyObject *raw = owned;
+    Py_ssize_t owned_start = Py_REFCNT(raw);
+    py::tmpref<py::object> moved(pyutils::to_python(std::move(owned)));
+    EXPECT_IS(moved, raw);
+    EXPECT_IS(owned, nullptr);
+    EXPECT_EQ(Py_REFCNT(raw), owned_start);
+
+    // lvalue tmprefs are shared
+    py::tmpref<py::object> shared(pyutils::to_python(moved));
+    EXPECT_IS(shared, raw);
+    EXPECT_EQ(Py_REFCNT(raw), owned_start + 1);
+
+    py::object null(nullptr);
+    EXPECT_EQ(pyutils::to_python(null), nullptr);
+}
@@ -0,0 +1,177 @@
+#include <cmath>
+#include <stdexcept>
+
+#include "gtest/gtest.h"
+#include <Python.h>
+
+#include "libpy/automethod.h"
+#include "libpy/libpy.h"
+#include "utils.h"
+
+using py::operator""_p;
+
+namespace {
+int live_points = 0;
+
+struct point {
+    double x;
+    double y;
+    int tag;
+
+    point() : point(0, 0) {}
+
+    point(double x, double y) : x(x), y(y), tag(7) {
+        if (std::isnan(x)) {
+            throw std::invalid_argument("x is nan");
+        }
+        ++live_points;
+    }
+
+    point(const point&) = delete;
+
+    ~point() {
+        --live_points;
+    }
+};
+
+double norm(PyObject *self) {
+    point &p = py::type::unbox<point>(self);
+    return std::sqrt(p.x * p.x + p.y * p.y);
+}
+
+void scale(PyObject *self, double factor) {
+    point &p = py::type::unbox<point>(self);
+    p.x *= factor;
+    p.y *= factor;
+}
+
+PyMethodDef norm_def = automethod(norm);
+PyMethodDef scale_def = automethod(scale);
+
+py::tmpref<py::type::object<>> point_type(bool with_constructor) {
+    py::type::builder<point> builder("test.point", "a point");
+    if (with_constructor) {
+        builder.constructor<double, double>();
+    }
+    return builder
+        .method(norm_def)
+        .method(scale_def)
+        .member("x", type_member(point, x))
+        .member("y", type_member(point, y))
+        .member("tag", type_member(point, tag), true)
+        .create();
+}
+}
+
+TEST(TypeBuilder, create) {
+    auto type = point_type(true);
+    ASSERT_TRUE(type.is_nonnull());
+    EXPECT_NO_PYTHON_ERR();
+
+    EXPECT_TRUE(PyType_Check(static_cast<PyObject*>(type)));
+    EXPECT_TRUE((type.getattr("__name__"_p) == "point"_p).istrue());
+    EXPECT_TRUE((type.getattr("__module__"_p) == "test"_p).istrue());
+    EXPECT_TRUE((type.getattr("__doc__"_p) == "a point"_p).istrue());
+}
+
+TEST(TypeBuilder, inline_storage) {
+    auto type = point_type(true);
+    ASSERT_TRUE(type.is_nonnull());
+
+    EXPECT_EQ(reinterpret_cast<PyTypeObject*>(
+                  static_cast<PyObject*>(type))->tp_basicsize,
+              static_cast<Py_ssize_t>(py::type::value_offset<point>() +
+                                      sizeof(point)));
+
+    int start = live_points;
+    {
+        auto p = type(3.0_p, 4.0_p);
+        ASSERT_TRUE(p.is_nonnull());
+        EXPECT_EQ(live_points, start + 1);
+
+        point &value = py::type::unbox<point>(p);
+        EXPECT_EQ(value.x, 3.0);
+        EXPECT_EQ(value.y, 4.0);
+    }
+    EXPECT_EQ(live_points, start);
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST(TypeBuilder, methods) {
+    auto type = point_type(true);
+    ASSERT_TRUE(type.is_nonnull());
+
+    auto p = type(3.0_p, 4.0_p);
+    ASSERT_TRUE(p.is_nonnull());
+
+    auto result = p.call_method("norm"_p);
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_TRUE((result == 5.0_p).istrue());
+
+    EXPECT_IS(p.call_method("scale"_p, 2_p), Py_None);
+    EXPECT_NO_PYTHON_ERR();
+    EXPECT_EQ(py::type::unbox<point>(p).x, 6.0);
+}
+
+TEST(TypeBuilder, members) {
+    auto type = point_type(true);
+    ASSERT_TRUE(type.is_nonnull());
+
+    auto p = type(3.0_p, 4.0_p);
+    ASSERT_TRUE(p.is_nonnull());
+
+    EXPECT_TRUE((p.getattr("x"_p) == 3.0_p).istrue());
+    EXPECT_TRUE((p.getattr("tag"_p) == 7_p).istrue());
+
+    ASSERT_EQ(p.setattr("y"_p, 1.5_p), 0);
+    EXPECT_EQ(py::type::unbox<point>(p).y, 1.5);
+
+    EXPECT_NE(p.setattr("tag"_p, 1_p), 0);
+    EXPECT_PYTHON_ERR(PyExc_AttributeError);
+}
+
+TEST(TypeBuilder, default_constructor) {
+    auto type = point_type(false);
+    ASSERT_TRUE(type.is_nonnull());
+
+    auto p = type();
+    ASSERT_TRUE(p.is_nonnull());
+    EXPECT_EQ(py::type::unbox<point>(p).x, 0.0);
+
+    EXPECT_FALSE(type(1.0_p, 2.0_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+}
+
+TEST(TypeBuilder, no_constructor) {
+    struct no_default {
+        explicit no_default(int) {}
+    };
+
+    auto type = py::type::builder<no_default>("test.no_default").create();
+    ASSERT_TRUE(type.is_nonnull());
+
+    EXPECT_FALSE(type().is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    py::tmpref<py::object> ob(py::type::emplace<no_default>(
+        reinterpret_cast<PyTypeObject*>(static_cast<PyObject*>(type)),
+        1));
+    EXPECT_TRUE(ob.is_nonnull());
+}
+
+TEST(TypeBuilder, constructor_errors) {
+    auto type = point_type(true);
+    ASSERT_TRUE(type.is_nonnull());
+
+    EXPECT_FALSE(type(1.0_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    EXPECT_FALSE(type("a"_p, 1.0_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    int start = live_points;
+    py::tmpref<py::object> nan(PyFloat_FromDouble(NAN));
+    EXPECT_FALSE(type(nan, 1.0_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_RuntimeError);
+    EXPECT_EQ(live_points, start);
+}
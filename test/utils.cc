@@ -2,6 +2,8 @@
 #include <cstdlib>
 #include <cxxabi.h>
 
+#include "utils.h"
+
 std::string demangle(const char *name) {
     int status;
     char *cs = abi::__cxa_demangle(name, 0, 0, &status);
@@ -9,3 +11,37 @@ std::string demangle(const char *name) {
     free(cs);
     return ret;
 }
+
+py::tmpref<py::object> make_namespace() {
+    py::tmpref<py::object> ns(PyDict_New());
+    if (!ns.is_nonnull() ||
+        PyDict_SetItemString(ns, "__builtins__", PyEval_GetBuiltins())) {
+        return nullptr;
+    }
+    py::tmpref<py::object> array(PyImport_ImportModule("array"));
+    if (!array.is_nonnull() || PyDict_SetItemString(ns, "array", array)) {
+        return nullptr;
+    }
+    return ns;
+}
+
+py::tmpref<py::object> eval(const char *expr, const py::object &ns) {
+    if (ns.is_nonnull()) {
+        return PyRun_String(expr, Py_eval_input, ns, ns);
+    }
+    py::tmpref<py::object> fresh = make_namespace();
+    if (!fresh.is_nonnull()) {
+        return nullptr;
+    }
+    return PyRun_String(expr, Py_eval_input, fresh, fresh);
+}
+
+int exec(const char *code, const py::object &ns) {
+    py::tmpref<py::object> result(
+        PyRun_String(code, Py_file_input, ns, ns));
+    return result.is_nonnull() ? 0 : -1;
+}
+
+py::tmpref<py::object> function(PyMethodDef &def) {
+    return PyCFunction_New(&def, nullptr);
+}
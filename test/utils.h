@@ -3,6 +3,8 @@
 #include "gtest/gtest.h"
 #include <Python.h>
 
+#include "libpy/object.h"
+
 /**
    Expectation that two object are the same object in memory.
 */
@@ -50,3 +52,42 @@
    @return     The demangled named.
 */
 std::string demangle(const char *name);
+
+/**
+   Create a namespace for `eval` and `exec` which has the builtins and
+   the `array` module.
+
+   @return The namespace, or nullptr with a Python exception set.
+*/
+py::tmpref<py::object> make_namespace();
+
+/**
+   Evaluate a Python expression.
+
+   @param expr The expression to evaluate.
+   @param ns   The namespace to evaluate `expr` in. By default this is a
+               new namespace from `make_namespace`.
+   @return     The value of `expr`, or nullptr with a Python exception
+               set.
+*/
+py::tmpref<py::object> eval(const char *expr,
+                            const py::object &ns = nullptr);
+
+/**
+   Run Python statements, for example class definitions.
+
+   @param code The statements to run.
+   @param ns   The namespace to run `code` in.
+   @return     zero on success, -1 on failure with a Python exception
+               set.
+*/
+int exec(const char *code, const py::object &ns);
+
+/**
+   Create a Python function from a method definition.
+
+   @param def The method definition, usually from `automethod`. This must
+              outlive the function.
+   @return    The function, or nullptr with a Python exception set.
+*/
+py::tmpref<py::object> function(PyMethodDef &def);